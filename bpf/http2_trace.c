@@ -0,0 +1,392 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// http2_trace.c — libbpf/CO-RE Go HTTP/2 (gRPC) 헤더 uprobe
+//
+// bpf/src/go_http2_trace.c(Pixie 원본, BCC 스타일)의 핵심 아이디어를
+// 이 트리의 libbpf/CO-RE 파이프라인에 맞게 이식한 것이다. 원본처럼
+// net/http2 내부 구조체(DWARF symaddrs)를 전부 추적하는 대신,
+// HPACK 인코더의 단일 함수에 uprobe를 건다:
+//
+//   golang.org/x/net/http2/hpack.(*Encoder).WriteField(f HeaderField)
+//
+// WriteField는 압축 전의 평문 (name, value) 쌍을 레지스터로 받으므로
+// 유저스페이스 HPACK 상태 추적 없이 디코딩된 헤더를 얻을 수 있다.
+// 클라이언트는 :method/:path를, 서버는 :status를 여기로 내보내기 때문에
+// east-west 양쪽 pod에서 요청·응답이 모두 관측된다.
+//
+// 이벤트 형식:
+//   pseudo-header를 {tgid, 인코더 포인터} 기준으로 모았다가 HTTP/1 스타일
+//   start-line으로 합성해 내보낸다 ("GET /svc HTTP/2.0", "HTTP/2.0 200").
+//   서버의 기존 httpparse/집계 파이프라인이 HTTP/1 이벤트와 동일하게
+//   처리할 수 있게 하기 위해서다.
+//
+// `events` ringbuf와 adaptive wakeup 맵은 nefi_trace의 것으로
+// MapReplacements 교체된다 (ssl_trace.c와 같은 방식).
+
+#include <linux/bpf.h>
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+
+typedef unsigned char       u8;
+typedef unsigned short      u16;
+typedef unsigned int        u32;
+typedef unsigned long long  u64;
+
+// ssl_trace.c와 동일한 pt_regs fallback — vmlinux.h 없이 PT_REGS_* 사용
+#if defined(__TARGET_ARCH_x86)
+struct pt_regs {
+	long r15, r14, r13, r12, rbp, rbx;
+	long r11, r10, r9, r8;
+	long rax, rcx, rdx, rsi, rdi, orig_rax;
+	long rip, cs, eflags, rsp, ss;
+};
+#else
+struct user_pt_regs {
+	u64 regs[31];
+	u64 sp;
+	u64 pc;
+	u64 pstate;
+};
+#endif
+
+// ringbuf notification flags — 오래된 uapi 헤더를 위한 fallback
+#ifndef BPF_RB_NO_WAKEUP
+#define BPF_RB_AVAIL_DATA   0
+#define BPF_RB_NO_WAKEUP    1
+#define BPF_RB_FORCE_WAKEUP 2
+#endif
+
+// Payload bucket — 합성 start-line은 항상 SMALL 버킷에 들어간다.
+#define EVENT_BUCKET_SMALL  256
+
+// Protocol / message-type constants — must match nefi_trace.c and model/events.go
+#define PROTO_HTTP2  2
+#define MSG_UNKNOWN  0
+#define MSG_REQUEST  1
+#define MSG_RESPONSE 2
+
+// 헤더 필드 길이 제한 (verifier 마스크에 쓰이므로 2의 거듭제곱 - 1)
+#define NAME_MAX   15  // ":method" 등 pseudo-header 이름은 짧다
+#define METHOD_MAX 15
+#define PATH_MAX_  127
+
+// ─── data_event_t: exact same packed layout as nefi_trace.c ─────
+
+struct data_event_t {
+	u64  timestamp_ns;
+	u32  pid;
+	u32  fd;       // 0 — uprobe 컨텍스트에서는 FD를 알 수 없다
+	u32  msg_size;
+	u8   direction; // 0 = send, 1 = recv
+	u8   protocol;
+	u8   msg_type;
+	char comm[16];
+	u32  remote_ip;   // 0 — unknown in uprobe context
+	u16  remote_port; // 0 — unknown in uprobe context
+	u64  latency_ns;  // 0 — pairing은 nefi_trace.c 쪽에서만 수행
+	u16  cap_len;
+	char msg[];
+} __attribute__((packed));
+
+// 인코더 포인터별로 pseudo-header를 모으는 누적 상태.
+// net/http2의 loopyWriter가 커넥션당 헤더 쓰기를 직렬화하므로
+// 같은 인코더에 대한 WriteField 호출은 헤더 블록 단위로 이어진다.
+struct http2_accum_t {
+	char method[METHOD_MAX + 1];
+	char path[PATH_MAX_ + 1];
+	u8   method_len;
+	u8   path_len;
+};
+
+// 맵은 전역인데 uprobe는 계측된 바이너리의 모든 프로세스에서 뜬다.
+// Go 힙 주소는 프로세스마다 거의 같은 배치(0xc000000000 arena)라, 같은
+// 바이너리 replica 여러 개가 한 노드에 있으면 인코더 포인터가 충돌할 수
+// 있다 — tgid를 키에 함께 넣어 프로세스 간 섞임을 막는다.
+// (항상 zero-init 후 필드를 채우므로 패딩 바이트도 0으로 일정하다.)
+struct http2_accum_key_t {
+	u32 tgid;
+	u64 enc; // hpack.Encoder pointer
+};
+
+// ─── BPF Maps ───────────────────────────────────────────────────
+
+// events: replaced at load time with nefi_trace's ring buffer
+struct {
+	__uint(type, BPF_MAP_TYPE_RINGBUF);
+	__uint(max_entries, 4 * 1024 * 1024); // 4 MB placeholder
+} events SEC(".maps");
+
+struct {
+	__uint(type, BPF_MAP_TYPE_LRU_HASH);
+	__uint(max_entries, 8192);
+	__type(key, struct http2_accum_key_t);
+	__type(value, struct http2_accum_t);
+} http2_accum SEC(".maps");
+
+// Adaptive wakeup 상태 — nefi_trace.c의 동명 맵으로 MapReplacements 교체
+struct wakeup_config_t {
+	u64 data_threshold;
+	u64 interval_ns;
+};
+
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 1);
+	__type(key, u32);
+	__type(value, struct wakeup_config_t);
+} wakeup_config SEC(".maps");
+
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 1);
+	__type(key, u32);
+	__type(value, u64);
+} last_wakeup_ts SEC(".maps");
+
+// Hot-path 카운터 — nefi_trace.c의 동명 per-CPU 맵으로 MapReplacements 교체.
+// 슬롯 인덱스는 nefi_trace.c의 STAT_* 정의와 일치해야 한다.
+#define STAT_SUBMITTED    0
+#define STAT_RESERVE_FAIL 1
+#define STAT_BYTES        2
+#define STAT_MAX          8
+
+struct {
+	__uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+	__uint(max_entries, STAT_MAX);
+	__type(key, u32);
+	__type(value, u64);
+} bpf_stats SEC(".maps");
+
+static __always_inline void stat_add(u32 idx, u64 delta)
+{
+	u64 *v = bpf_map_lookup_elem(&bpf_stats, &idx);
+	if (v)
+		*v += delta;
+}
+
+// ─── Go register-ABI macros ──────────────────────────────────────
+// WriteField(f HeaderField): receiver + (Name.ptr, Name.len, Value.ptr,
+// Value.len, Sensitive) 순서로 정수 레지스터에 실린다 (Go 1.17+ ABI).
+
+#if defined(__TARGET_ARCH_x86)
+  #define GO_RECV(ctx)  ((ctx)->rax)  // receiver *Encoder
+  #define GO_ARG1(ctx)  ((ctx)->rbx)  // f.Name.ptr
+  #define GO_ARG2(ctx)  ((ctx)->rcx)  // f.Name.len
+  #define GO_ARG3(ctx)  ((ctx)->rdi)  // f.Value.ptr
+  #define GO_ARG4(ctx)  ((ctx)->rsi)  // f.Value.len
+#else
+  #define GO_RECV(ctx)  PT_REGS_PARM1(ctx)
+  #define GO_ARG1(ctx)  PT_REGS_PARM2(ctx)
+  #define GO_ARG2(ctx)  PT_REGS_PARM3(ctx)
+  #define GO_ARG3(ctx)  PT_REGS_PARM4(ctx)
+  #define GO_ARG4(ctx)  PT_REGS_PARM5(ctx)
+#endif
+
+// ─── Emit helpers ────────────────────────────────────────────────
+
+// submit_flags — nefi_trace.c와 동일한 adaptive wakeup 판정.
+static __always_inline u64 submit_flags(void)
+{
+	u32 key = 0;
+	struct wakeup_config_t *wc = bpf_map_lookup_elem(&wakeup_config, &key);
+	if (!wc || (wc->data_threshold == 0 && wc->interval_ns == 0))
+		return 0;
+
+	if (wc->data_threshold &&
+	    bpf_ringbuf_query(&events, BPF_RB_AVAIL_DATA) >= wc->data_threshold)
+		goto wake;
+
+	if (wc->interval_ns) {
+		u64 *last = bpf_map_lookup_elem(&last_wakeup_ts, &key);
+		if (last && bpf_ktime_get_ns() - *last >= wc->interval_ns)
+			goto wake;
+	}
+	return BPF_RB_NO_WAKEUP;
+
+wake: {
+	u64 now = bpf_ktime_get_ns();
+	u64 *last = bpf_map_lookup_elem(&last_wakeup_ts, &key);
+	if (last)
+		*last = now;
+	return BPF_RB_FORCE_WAKEUP;
+}
+}
+
+static __always_inline void fill_http2_hdr(struct data_event_t *event, u8 mtype)
+{
+	u64 id  = bpf_get_current_pid_tgid();
+	u32 pid = id >> 32;
+
+	event->timestamp_ns = bpf_ktime_get_ns();
+	event->pid          = pid;
+	event->fd           = 0;
+	event->direction    = 0; // WriteField는 항상 송신 경로
+	event->msg_size     = 0; // emit 후 cap_len과 동일하게 채운다
+	event->protocol     = PROTO_HTTP2;
+	event->msg_type     = mtype;
+	bpf_get_current_comm(&event->comm, sizeof(event->comm));
+	event->remote_ip    = 0;
+	event->remote_port  = 0;
+	event->latency_ns   = 0;
+}
+
+// emit_http2_request: "METHOD PATH HTTP/2.0\r\n\r\n" 합성 이벤트.
+// 최대 길이 15 + 1 + 127 + 13 = 156 < 256 — SMALL 버킷 하나로 충분하다.
+static __always_inline int emit_http2_request(struct http2_accum_t *acc)
+{
+	struct data_event_t *event = bpf_ringbuf_reserve(
+		&events, sizeof(*event) + EVENT_BUCKET_SMALL, 0);
+	if (!event) {
+		stat_add(STAT_RESERVE_FAIL, 1);
+		return 0;
+	}
+	fill_http2_hdr(event, MSG_REQUEST);
+
+	u32 pos = 0;
+	for (u32 i = 0; i < METHOD_MAX; i++) {
+		if (i >= acc->method_len)
+			break;
+		event->msg[pos & (EVENT_BUCKET_SMALL - 1)] = acc->method[i & METHOD_MAX];
+		pos++;
+	}
+	event->msg[pos & (EVENT_BUCKET_SMALL - 1)] = ' ';
+	pos++;
+	for (u32 i = 0; i < PATH_MAX_; i++) {
+		if (i >= acc->path_len)
+			break;
+		event->msg[pos & (EVENT_BUCKET_SMALL - 1)] = acc->path[i & PATH_MAX_];
+		pos++;
+	}
+	const char suffix[13] = " HTTP/2.0\r\n\r\n";
+	for (u32 i = 0; i < sizeof(suffix); i++) {
+		event->msg[pos & (EVENT_BUCKET_SMALL - 1)] = suffix[i];
+		pos++;
+	}
+
+	event->cap_len  = (u16)pos;
+	event->msg_size = pos;
+	bpf_ringbuf_submit(event, submit_flags());
+	stat_add(STAT_SUBMITTED, 1);
+	stat_add(STAT_BYTES, pos);
+	return 0;
+}
+
+// emit_http2_response: "HTTP/2.0 NNN \r\n\r\n" 합성 이벤트.
+static __always_inline int emit_http2_response(u64 val_ptr, u64 val_len)
+{
+	struct data_event_t *event = bpf_ringbuf_reserve(
+		&events, sizeof(*event) + EVENT_BUCKET_SMALL, 0);
+	if (!event) {
+		stat_add(STAT_RESERVE_FAIL, 1);
+		return 0;
+	}
+	fill_http2_hdr(event, MSG_RESPONSE);
+
+	const char prefix[9] = "HTTP/2.0 ";
+	u32 pos = 0;
+	for (u32 i = 0; i < sizeof(prefix); i++) {
+		event->msg[pos & (EVENT_BUCKET_SMALL - 1)] = prefix[i];
+		pos++;
+	}
+
+	char status[8] = {};
+	u32 slen = (u32)val_len;
+	if (slen > 7)
+		slen = 7;
+	slen &= 7;
+	bpf_probe_read_user(status, slen, (void *)val_ptr);
+	for (u32 i = 0; i < 7; i++) {
+		if (i >= slen)
+			break;
+		event->msg[pos & (EVENT_BUCKET_SMALL - 1)] = status[i & 7];
+		pos++;
+	}
+
+	const char suffix[5] = " \r\n\r\n";
+	for (u32 i = 0; i < sizeof(suffix); i++) {
+		event->msg[pos & (EVENT_BUCKET_SMALL - 1)] = suffix[i];
+		pos++;
+	}
+
+	event->cap_len  = (u16)pos;
+	event->msg_size = pos;
+	bpf_ringbuf_submit(event, submit_flags());
+	stat_add(STAT_SUBMITTED, 1);
+	stat_add(STAT_BYTES, pos);
+	return 0;
+}
+
+// ─── hpack.(*Encoder).WriteField ─────────────────────────────────
+
+SEC("uprobe/go_hpack_write_field")
+int uprobe_hpack_write_field(struct pt_regs *ctx)
+{
+	u64 name_ptr = GO_ARG1(ctx);
+	u64 name_len = GO_ARG2(ctx);
+	u64 val_ptr  = GO_ARG3(ctx);
+	u64 val_len  = GO_ARG4(ctx);
+
+	if (!name_ptr || name_len == 0)
+		return 0;
+
+	struct http2_accum_key_t key = {};
+	key.tgid = (u32)(bpf_get_current_pid_tgid() >> 32);
+	key.enc  = GO_RECV(ctx);
+
+	char name[NAME_MAX + 1] = {};
+	u32 nlen = (u32)name_len;
+	if (nlen > NAME_MAX)
+		nlen = NAME_MAX;
+	nlen &= NAME_MAX;
+	bpf_probe_read_user(name, nlen, (void *)name_ptr);
+
+	// ── pseudo-header 분기 ──
+	if (name[0] == ':') {
+		if (nlen == 7 && name[1] == 'm' && name[2] == 'e' &&
+		    name[3] == 't' && name[4] == 'h' && name[5] == 'o' &&
+		    name[6] == 'd') {
+			// :method — 새 요청 헤더 블록의 시작으로 본다
+			struct http2_accum_t acc = {};
+			u32 vlen = (u32)val_len;
+			if (vlen > METHOD_MAX)
+				vlen = METHOD_MAX;
+			vlen &= METHOD_MAX;
+			bpf_probe_read_user(acc.method, vlen, (void *)val_ptr);
+			acc.method_len = (u8)vlen;
+			bpf_map_update_elem(&http2_accum, &key, &acc, BPF_ANY);
+			return 0;
+		}
+		if (nlen == 5 && name[1] == 'p' && name[2] == 'a' &&
+		    name[3] == 't' && name[4] == 'h') {
+			struct http2_accum_t *acc =
+				bpf_map_lookup_elem(&http2_accum, &key);
+			if (!acc)
+				return 0;
+			u32 vlen = (u32)val_len;
+			if (vlen > PATH_MAX_)
+				vlen = PATH_MAX_;
+			vlen &= PATH_MAX_;
+			bpf_probe_read_user(acc->path, vlen, (void *)val_ptr);
+			acc->path_len = (u8)vlen;
+			return 0;
+		}
+		if (nlen == 7 && name[1] == 's' && name[2] == 't' &&
+		    name[3] == 'a' && name[4] == 't' && name[5] == 'u' &&
+		    name[6] == 's') {
+			// :status — 응답 헤더 블록, 즉시 합성 이벤트로 내보낸다
+			return emit_http2_response(val_ptr, val_len);
+		}
+		// :authority, :scheme 등은 start-line 합성에 쓰지 않는다
+		return 0;
+	}
+
+	// ── 첫 regular header: 요청 pseudo-header 블록이 끝났다는 신호 ──
+	struct http2_accum_t *acc = bpf_map_lookup_elem(&http2_accum, &key);
+	if (!acc || acc->method_len == 0)
+		return 0;
+	emit_http2_request(acc);
+	bpf_map_delete_elem(&http2_accum, &key);
+	return 0;
+}
+
+char LICENSE[] SEC("license") = "GPL";
@@ -16,6 +16,13 @@
 #define bpf_htons(x) __builtin_bswap16(x)
 #endif
 
+// ringbuf notification flags — 오래된 uapi 헤더를 위한 fallback
+#ifndef BPF_RB_NO_WAKEUP
+#define BPF_RB_AVAIL_DATA   0
+#define BPF_RB_NO_WAKEUP    1
+#define BPF_RB_FORCE_WAKEUP 2
+#endif
+
 typedef unsigned char  u8;
 typedef unsigned short u16;
 typedef unsigned int   u32;
@@ -29,6 +36,12 @@ typedef short          s16;
 #define PROBE_BUF_SIZE 64
 #define AF_INET 2
 
+// Variable-length ringbuf records: the payload is bucketed to the smallest
+// of these sizes that fits, so the verifier still sees a constant reserve
+// size but small messages stop paying the 4 KB worst case.
+#define EVENT_BUCKET_SMALL  256
+#define EVENT_BUCKET_MEDIUM 1024
+
 // ─── Network address structs ────────────────────────────────────
 
 struct sockaddr_in {
@@ -85,6 +98,9 @@ enum msg_type_t {
 
 // ─── Data structures ────────────────────────────────────────────
 
+// Variable-length record: 55-byte header + payload sized to the actual
+// capture length (bucketed). cap_len is the number of payload bytes present
+// in this record; msg_size is the full syscall transfer size.
 struct data_event_t {
 	u64  timestamp_ns;
 	u32  pid;
@@ -96,8 +112,9 @@ struct data_event_t {
 	char comm[16];
 	u32  remote_ip;   // host byte order (bpf_ntohl applied)
 	u16  remote_port; // host byte order (bpf_ntohs applied)
-	u16  _pad;
-	char msg[MAX_MSG_SIZE];
+	u64  latency_ns;  // request→response latency, 응답 이벤트에서만 설정 (0 = unknown)
+	u16  cap_len;     // payload bytes following this header
+	char msg[];       // bucket-sized flexible payload
 } __attribute__((packed));
 
 struct args_t {
@@ -117,14 +134,41 @@ struct accept_args_t {
 	u64 sockaddr_ptr;
 };
 
-// Per-connection state for stateful protocol detection (MySQL, Kafka).
+// Pre-aggregation mode: per-flow 집계 키/값 (agg_stats 맵).
+struct agg_key_t {
+	u32 pid;
+	u32 remote_ip;   // host byte order; 0 if unknown
+	u8  protocol;
+	u8  msg_type;
+	u16 _pad;        // Go 쪽 키 레이아웃과 일치하도록 명시적 패딩
+};
+
+struct agg_stat_t {
+	u64 count;
+	u64 bytes;
+	u64 latency_sum_ns; // 페어링된 request→response latency의 누적 합
+	u64 latency_count;  // latency_sum_ns에 포함된 샘플 수
+};
+
+// Per-connection state for stateful protocol detection (MySQL, Kafka),
+// in-kernel request→response latency pairing, and split-read coalescing.
 struct conn_state_t {
 	u8   protocol;
+	u8   cont_dir;   // 접힌 continuation chunk들의 방향 (0 = send, 1 = recv)
 	u32  prev_count;
 	char prev_buf[4];
+	u64  req_ts_ns;  // 마지막 MSG_REQUEST의 타임스탬프 (0 = pending request 없음)
+	u64  cont_bytes; // coalesce 모드: 마지막 head 이후 접어 둔 continuation 바이트
+	u32  cont_chunks; // 접힌 chunk 수 (메트릭/디버깅용)
 };
 
 // ─── BPF Maps ───────────────────────────────────────────────────
+//
+// Per-connection 맵들은 LRU_HASH다: 용량이 차면 insert가 조용히 실패하는
+// 대신 가장 오래 안 쓰인 엔트리를 밀어내므로, 커넥션 churn이 심한 노드에서
+// close 이벤트를 놓쳐도 새 커넥션의 attribution이 깨지지 않는다.
+// max_entries는 기본값일 뿐이고 agent가 로드 전에 노드 프로필에 맞게
+// 재설정한다 (loader.go의 Config.MapMaxEntries).
 
 struct {
 	__uint(type, BPF_MAP_TYPE_RINGBUF);
@@ -132,21 +176,21 @@ struct {
 } events SEC(".maps");
 
 struct {
-	__uint(type, BPF_MAP_TYPE_HASH);
+	__uint(type, BPF_MAP_TYPE_LRU_HASH);
 	__uint(max_entries, 65536);
 	__type(key, u64);  // pid<<32 | fd
 	__type(value, u8);
 } socket_fds SEC(".maps");
 
 struct {
-	__uint(type, BPF_MAP_TYPE_HASH);
+	__uint(type, BPF_MAP_TYPE_LRU_HASH);
 	__uint(max_entries, 65536);
 	__type(key, u64); // pid_tgid
 	__type(value, struct args_t);
 } active_send_args SEC(".maps");
 
 struct {
-	__uint(type, BPF_MAP_TYPE_HASH);
+	__uint(type, BPF_MAP_TYPE_LRU_HASH);
 	__uint(max_entries, 65536);
 	__type(key, u64);
 	__type(value, struct args_t);
@@ -154,7 +198,7 @@ struct {
 
 // Connection state map for stateful protocol detection.
 struct {
-	__uint(type, BPF_MAP_TYPE_HASH);
+	__uint(type, BPF_MAP_TYPE_LRU_HASH);
 	__uint(max_entries, 65536);
 	__type(key, u64);  // pid<<32 | fd
 	__type(value, struct conn_state_t);
@@ -162,7 +206,7 @@ struct {
 
 // Remote endpoint info per connection.
 struct {
-	__uint(type, BPF_MAP_TYPE_HASH);
+	__uint(type, BPF_MAP_TYPE_LRU_HASH);
 	__uint(max_entries, 65536);
 	__type(key, u64);  // pid<<32 | fd
 	__type(value, struct conn_info_t);
@@ -170,12 +214,160 @@ struct {
 
 // Saves sockaddr pointer from accept4/accept enter for use in exit.
 struct {
-	__uint(type, BPF_MAP_TYPE_HASH);
+	__uint(type, BPF_MAP_TYPE_LRU_HASH);
 	__uint(max_entries, 65536);
 	__type(key, u64);  // pid_tgid
 	__type(value, struct accept_args_t);
 } active_accept_args SEC(".maps");
 
+// Protocol filter, indexed by enum protocol_t. The agent sets the entries
+// it wants to 1 at load time; protocols left at 0 pay only the inference
+// cost and never reach bpf_ringbuf_reserve (no copy, no reader wakeup).
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 16);
+	__type(key, u32);
+	__type(value, u8);
+} protocol_filter SEC(".maps");
+
+// Pre-aggregation 토글 (index 0). 1이면 이벤트를 ringbuf로 내보내는 대신
+// agg_stats 카운터만 갱신한다 — 고QPS ingress 노드용.
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 1);
+	__type(key, u32);
+	__type(value, u8);
+} agg_mode SEC(".maps");
+
+// Split-read coalescing 토글 (index 0). 1이면 프로토콜이 분류된 커넥션에서
+// 메시지 head 뒤로 이어지는 판별 불가 chunk(큰 응답을 여러 번 read하는
+// Java NIO 등)를 이벤트로 내보내지 않고 conn_state의 byte 카운터로 접어
+// 둔다. 다음 head 직전에 header-only 요약 레코드 하나로 합산해 내보낸다.
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 1);
+	__type(key, u32);
+	__type(value, u8);
+} coalesce_mode SEC(".maps");
+
+// Per-CPU 집계 카운터. agent가 1초마다 drain(합산 후 삭제)한다.
+// per-CPU라 syscall 핫패스에서 atomic 연산 없이 증가시킬 수 있다.
+struct {
+	__uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+	__uint(max_entries, 16384);
+	__type(key, struct agg_key_t);
+	__type(value, struct agg_stat_t);
+} agg_stats SEC(".maps");
+
+// PID allow/deny 필터. data-path tracepoint(enter) 최상단에서 검사해
+// 걸러진 프로세스는 버퍼 복사/inference 비용 없이 lookup 한 번으로 끝난다.
+// agent가 자기 PID를 로드 시점에 deny하고, 제외 대상 pod의 PID를 런타임에
+// 추가한다 (main.go의 lazy 채움). 모드는 pid_filter_mode[0]:
+#define PID_FILTER_OFF   0 // 필터 비활성 (기본)
+#define PID_FILTER_DENY  1 // 목록에 있는 PID를 제외
+#define PID_FILTER_ALLOW 2 // 목록에 있는 PID만 캡처
+struct {
+	__uint(type, BPF_MAP_TYPE_HASH);
+	__uint(max_entries, 16384);
+	__type(key, u32); // pid
+	__type(value, u8);
+} pid_filter SEC(".maps");
+
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 1);
+	__type(key, u32);
+	__type(value, u8);
+} pid_filter_mode SEC(".maps");
+
+// Per-protocol 캡처 정책. agent가 런타임에 갱신한다 (재로드 불필요).
+// max_capture: 페이로드 byte cap (0 = MAX_MSG_SIZE까지 전부)
+// sample_n:    N개 이벤트 중 1개만 페이로드 포함 (0/1 = 전부),
+//              나머지는 cap_len=0인 header-only 레코드로 나간다.
+struct capture_policy_t {
+	u32 max_capture;
+	u32 sample_n;
+};
+
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 16);
+	__type(key, u32);
+	__type(value, struct capture_policy_t);
+} capture_policy SEC(".maps");
+
+// 샘플링 카운터 (프로토콜별). per-CPU라 atomic 없이 증가 —
+// CPU 수만큼 위상이 어긋나지만 1-in-N 비율 자체는 유지된다.
+struct {
+	__uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+	__uint(max_entries, 16);
+	__type(key, u32);
+	__type(value, u64);
+} sample_counters SEC(".maps");
+
+// Adaptive wakeup 파라미터 (index 0). 둘 다 0이면 batching 비활성 —
+// 레코드마다 기본 notify (기존 동작).
+struct wakeup_config_t {
+	u64 data_threshold; // ringbuf 미소비 바이트가 이를 넘으면 강제 wakeup
+	u64 interval_ns;    // 마지막 wakeup 이후 이 시간이 지나면 강제 wakeup
+};
+
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 1);
+	__type(key, u32);
+	__type(value, struct wakeup_config_t);
+} wakeup_config SEC(".maps");
+
+// 마지막 강제 wakeup 시각 (index 0). wakeup은 reader 전역 이벤트이므로
+// per-CPU가 아닌 공유 값으로 둔다 — 약간의 race는 wakeup 한 번 더/덜로
+// 끝나는 무해한 수준이다. ssl_trace.c와 MapReplacements로 공유된다.
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 1);
+	__type(key, u32);
+	__type(value, u64);
+} last_wakeup_ts SEC(".maps");
+
+// Hot-path drop/throughput 카운터. reserve 실패는 지금까지 아무 흔적 없이
+// 이벤트가 사라지는 유일한 지점이었다 — agent의 /metrics가 이 맵을 합산해
+// Prometheus 카운터로 노출한다. per-CPU라 atomic 없이 증가할 수 있다.
+// ssl_trace.c / http2_trace.c와 MapReplacements로 공유된다.
+#define STAT_SUBMITTED    0 // ringbuf에 제출된 이벤트 수
+#define STAT_RESERVE_FAIL 1 // bpf_ringbuf_reserve 실패 (= drop된 이벤트 수)
+#define STAT_BYTES        2 // 제출된 payload 바이트 합 (cap_len 기준)
+#define STAT_COALESCED    3 // coalesce 모드로 접혀 ringbuf를 건너뛴 chunk 수
+#define STAT_MAX          8
+
+struct {
+	__uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+	__uint(max_entries, STAT_MAX);
+	__type(key, u32);
+	__type(value, u64);
+} bpf_stats SEC(".maps");
+
+static __always_inline void stat_add(u32 idx, u64 delta)
+{
+	u64 *v = bpf_map_lookup_elem(&bpf_stats, &idx);
+	if (v)
+		*v += delta;
+}
+
+// pid_filtered는 이 PID의 syscall을 캡처에서 제외할지 판정한다.
+// 모드 off면 ARRAY lookup 한 번, 켜져 있으면 HASH lookup이 하나 더 붙는다.
+static __always_inline int pid_filtered(u32 pid)
+{
+	u32 mk = 0;
+	u8 *mode = bpf_map_lookup_elem(&pid_filter_mode, &mk);
+	if (!mode || *mode == PID_FILTER_OFF)
+		return 0;
+
+	u8 *entry = bpf_map_lookup_elem(&pid_filter, &pid);
+	if (*mode == PID_FILTER_DENY)
+		return entry != 0;
+	return entry == 0; // allow-list: 목록에 없는 PID는 제외
+}
+
 // ─── Helpers (ported from Pixie bpf_tools/utils.h) ──────────────
 
 static __always_inline s32 read_big_endian_s32(const char *buf)
@@ -667,8 +859,114 @@ static __always_inline struct infer_result_t infer_protocol(
 	return r;
 }
 
+// infer_msg_type_cached는 프로토콜이 이미 분류된 커넥션에서 msg_type만
+// 다시 판별한다. 전체 inference 체인(최대 12개 함수) 대신 해당 프로토콜의
+// 판별 함수 하나만 호출하므로, 수 시간을 사는 Kafka/MySQL 커넥션의
+// 초당 수백만 read에서도 syscall 경로 비용이 lookup 한 번 수준에 머문다.
+static __always_inline u8 infer_msg_type_cached(u8 proto, const char *buf,
+						u32 count, struct conn_state_t *cs)
+{
+	switch (proto) {
+	case PROTO_TLS:   return infer_tls(buf, count);
+	case PROTO_HTTP:  return infer_http(buf, count);
+	case PROTO_CQL:   return infer_cql(buf, count);
+	case PROTO_MONGO: return infer_mongo(buf, count);
+	case PROTO_PGSQL: return infer_pgsql(buf, count);
+	case PROTO_MYSQL: return infer_mysql(buf, count, cs);
+	case PROTO_MUX:   return infer_mux(buf, count);
+	case PROTO_KAFKA: return infer_kafka(buf, count, cs);
+	case PROTO_DNS:   return infer_dns(buf, count);
+	case PROTO_AMQP:  return infer_amqp(buf, count);
+	case PROTO_NATS:  return infer_nats(buf, count);
+	default:          return MSG_UNKNOWN; // Redis 등 msg_type 구분이 없는 프로토콜
+	}
+}
+
 // ─── Emit helper ────────────────────────────────────────────────
 
+// fill_event_hdr populates the fixed header of a reserved event record.
+static __always_inline void fill_event_hdr(struct data_event_t *event,
+					   struct args_t *a, long bytes,
+					   u8 direction, u8 proto, u8 mtype,
+					   u32 pid, u64 conn_key, u64 latency_ns)
+{
+	event->timestamp_ns = bpf_ktime_get_ns();
+	event->pid       = pid;
+	event->fd        = a->fd;
+	event->direction = direction;
+	event->msg_size  = (u32)bytes;
+	event->protocol  = proto;
+	event->msg_type  = mtype;
+	event->latency_ns = latency_ns;
+	bpf_get_current_comm(&event->comm, sizeof(event->comm));
+
+	struct conn_info_t *ci = bpf_map_lookup_elem(&conn_info, &conn_key);
+	if (ci) {
+		event->remote_ip   = ci->remote_ip;
+		event->remote_port = ci->remote_port;
+	} else {
+		event->remote_ip   = 0;
+		event->remote_port = 0;
+	}
+}
+
+// submit_flags는 adaptive wakeup 정책에 따른 bpf_ringbuf_submit 플래그를
+// 계산한다. 기본은 NO_WAKEUP으로 제출해 이벤트당 reader 컨텍스트 스위치를
+// 없애고, 미소비 데이터가 threshold를 넘거나 interval이 경과했을 때만
+// FORCE_WAKEUP으로 reader를 깨운다. 다음 이벤트가 없으면 마지막 배치가
+// 최대 interval만큼 늦게 소비될 수 있다 — 관측 파이프라인에서는 무해하다.
+static __always_inline u64 submit_flags(void)
+{
+	u32 key = 0;
+	struct wakeup_config_t *wc = bpf_map_lookup_elem(&wakeup_config, &key);
+	if (!wc || (wc->data_threshold == 0 && wc->interval_ns == 0))
+		return 0; // batching 미설정 — 레코드마다 기본 notify
+
+	if (wc->data_threshold &&
+	    bpf_ringbuf_query(&events, BPF_RB_AVAIL_DATA) >= wc->data_threshold)
+		goto wake;
+
+	if (wc->interval_ns) {
+		u64 *last = bpf_map_lookup_elem(&last_wakeup_ts, &key);
+		if (last && bpf_ktime_get_ns() - *last >= wc->interval_ns)
+			goto wake;
+	}
+	return BPF_RB_NO_WAKEUP;
+
+wake: {
+	u64 now = bpf_ktime_get_ns();
+	u64 *last = bpf_map_lookup_elem(&last_wakeup_ts, &key);
+	if (last)
+		*last = now;
+	return BPF_RB_FORCE_WAKEUP;
+}
+}
+
+// EMIT_SIZED: reserve header + SZ, fill, copy payload, submit.
+// A macro so every bucket keeps its own constant reserve size and bounded
+// copy — the verifier tracks each path separately and never has to merge
+// ringbuf allocations of different sizes.
+#define EMIT_SIZED(SZ)							\
+	do {								\
+		struct data_event_t *event = bpf_ringbuf_reserve(	\
+			&events, sizeof(*event) + (SZ), 0);		\
+		if (!event) {						\
+			stat_add(STAT_RESERVE_FAIL, 1);			\
+			return 0;					\
+		}							\
+		fill_event_hdr(event, a, bytes, direction,		\
+			       proto, mtype, pid, conn_key, latency_ns); \
+		u32 copy = want; /* capture policy로 cap된 길이 */	\
+		if (copy >= (SZ))					\
+			copy = (SZ) - 1;				\
+		copy &= ((SZ) - 1); /* verifier: prove copy < SZ */	\
+		bpf_probe_read_user(&event->msg, copy + 1, (void *)a->buf); \
+		event->cap_len = (u16)(copy + 1);			\
+		bpf_ringbuf_submit(event, submit_flags());		\
+		stat_add(STAT_SUBMITTED, 1);				\
+		stat_add(STAT_BYTES, copy + 1);				\
+	} while (0)
+
 static __always_inline int emit_event(struct args_t *a, long bytes, u8 direction)
 {
 	u64 id  = bpf_get_current_pid_tgid();
@@ -692,8 +990,10 @@ static __always_inline int emit_event(struct args_t *a, long bytes, u8 direction
 	u8 mtype;
 
 	if (cs && cs->protocol != PROTO_UNKNOWN) {
+		// 캐시 적중: 프로토콜은 lookup 한 번으로 끝내고, latency 페어링에
+		// 필요한 msg_type만 해당 프로토콜의 판별 함수로 다시 구한다.
 		proto = cs->protocol;
-		mtype = MSG_UNKNOWN;
+		mtype = infer_msg_type_cached(proto, probe, probe_len, cs);
 	} else {
 		struct infer_result_t r = infer_protocol(probe, probe_len, cs);
 		proto = r.protocol;
@@ -719,40 +1019,153 @@ static __always_inline int emit_event(struct args_t *a, long bytes, u8 direction
 		struct conn_state_t new_cs = {};
 		new_cs.protocol = cs->protocol;
 		new_cs.prev_count = 0;
+		new_cs.req_ts_ns = cs->req_ts_ns;     // pending request 유지
+		new_cs.cont_bytes = cs->cont_bytes;   // 접힌 continuation 유지
+		new_cs.cont_chunks = cs->cont_chunks;
+		new_cs.cont_dir = cs->cont_dir;
 		bpf_map_update_elem(&conn_state, &conn_key, &new_cs, BPF_ANY);
 	}
 
-	// ── Phase 2: ringbuf reserve + payload copy (simple, verifier-friendly) ──
-	struct data_event_t *event = bpf_ringbuf_reserve(&events, sizeof(*event), 0);
-	if (!event)
+	// ── In-kernel request→response latency pairing ──
+	// MSG_REQUEST에서 타임스탬프를 기록하고, 같은 커넥션의 MSG_RESPONSE에서
+	// 차이를 계산해 이벤트에 실어 보낸다. 유저스페이스 페어링 없이
+	// 커널이 본 정확한 시각 기준의 latency를 얻는다.
+	u64 latency_ns = 0;
+	if (mtype != MSG_UNKNOWN) {
+		struct conn_state_t *lcs = bpf_map_lookup_elem(&conn_state, &conn_key);
+		if (lcs) {
+			u64 now = bpf_ktime_get_ns();
+			if (mtype == MSG_REQUEST) {
+				lcs->req_ts_ns = now;
+			} else if (mtype == MSG_RESPONSE && lcs->req_ts_ns != 0) {
+				if (now > lcs->req_ts_ns)
+					latency_ns = now - lcs->req_ts_ns;
+				lcs->req_ts_ns = 0;
+			}
+		}
+	}
+
+	// ── In-kernel protocol filter: 허용되지 않은 프로토콜은 여기서 끝 ──
+	u32 pf_key = proto;
+	u8 *pf_allowed = bpf_map_lookup_elem(&protocol_filter, &pf_key);
+	if (!pf_allowed || *pf_allowed == 0)
 		return 0;
 
-	event->timestamp_ns = bpf_ktime_get_ns();
-	event->pid       = pid;
-	event->fd        = a->fd;
-	event->direction = direction;
-	event->msg_size  = (u32)bytes;
-	event->protocol  = proto;
-	event->msg_type  = mtype;
-	bpf_get_current_comm(&event->comm, sizeof(event->comm));
+	// ── Pre-aggregation mode: 이벤트 대신 per-CPU 카운터만 갱신 ──
+	// 고QPS 노드에서는 per-event 전송이 ringbuf 용량을 넘어서므로,
+	// (pid, remote_ip, protocol, msg_type)별 카운터를 쌓고 agent가
+	// 1초마다 drain해 synthetic stat 이벤트로 내보낸다.
+	u32 am_key = 0;
+	u8 *am = bpf_map_lookup_elem(&agg_mode, &am_key);
+	if (am && *am) {
+		struct agg_key_t ak = {};
+		ak.pid      = pid;
+		ak.protocol = proto;
+		ak.msg_type = mtype;
+		struct conn_info_t *aci = bpf_map_lookup_elem(&conn_info, &conn_key);
+		if (aci)
+			ak.remote_ip = aci->remote_ip;
+
+		struct agg_stat_t *st = bpf_map_lookup_elem(&agg_stats, &ak);
+		if (st) {
+			st->count++;
+			st->bytes += (u64)bytes;
+			if (latency_ns) {
+				st->latency_sum_ns += latency_ns;
+				st->latency_count++;
+			}
+		} else {
+			struct agg_stat_t init = {};
+			init.count = 1;
+			init.bytes = (u64)bytes;
+			if (latency_ns) {
+				init.latency_sum_ns = latency_ns;
+				init.latency_count = 1;
+			}
+			bpf_map_update_elem(&agg_stats, &ak, &init, BPF_ANY);
+		}
+		return 0;
+	}
 
-	struct conn_info_t *ci = bpf_map_lookup_elem(&conn_info, &conn_key);
-	if (ci) {
-		event->remote_ip   = ci->remote_ip;
-		event->remote_port = ci->remote_port;
-	} else {
-		event->remote_ip   = 0;
-		event->remote_port = 0;
+	// ── Split-read coalescing: continuation chunk는 이벤트로 내보내지 않는다 ──
+	// 큰 응답을 작은 read로 나눠 받는 워크로드(Java NIO 등)는 head 한 번 뒤에
+	// msg_type 판별이 불가능한 body 조각을 줄줄이 만든다 — 서버는 어차피
+	// 파싱하지 못하는 페이로드다. 프로토콜이 분류된 커넥션에서 그런 chunk는
+	// conn_state의 byte 카운터로 접어 두고, 같은 fd의 다음 head가 보이면
+	// 직전 메시지의 합계를 header-only 레코드 하나로 flush한다.
+	// (close를 놓치면 마지막 메시지의 꼬리 합계가 유실될 수 있다 — 집계는
+	// head 이벤트 기준이라 무해하다.)
+	u32 co_key = 0;
+	u8 *co = bpf_map_lookup_elem(&coalesce_mode, &co_key);
+	if (co && *co) {
+		struct conn_state_t *ccs = bpf_map_lookup_elem(&conn_state, &conn_key);
+		if (ccs && ccs->protocol != PROTO_UNKNOWN) {
+			if (mtype == MSG_UNKNOWN) {
+				ccs->cont_bytes += (u64)bytes;
+				ccs->cont_chunks += 1;
+				ccs->cont_dir = direction;
+				stat_add(STAT_COALESCED, 1);
+				return 0;
+			}
+			if (ccs->cont_bytes) {
+				struct data_event_t *sum = bpf_ringbuf_reserve(
+					&events, sizeof(*sum), 0);
+				if (sum) {
+					fill_event_hdr(sum, a, (long)ccs->cont_bytes,
+						       ccs->cont_dir, proto,
+						       MSG_UNKNOWN, pid, conn_key, 0);
+					sum->cap_len = 0;
+					bpf_ringbuf_submit(sum, submit_flags());
+					stat_add(STAT_SUBMITTED, 1);
+				} else {
+					stat_add(STAT_RESERVE_FAIL, 1);
+				}
+				ccs->cont_bytes = 0;
+				ccs->cont_chunks = 0;
+			}
+		}
+	}
+
+	// ── Capture policy: per-protocol byte cap + 1-in-N payload sampling ──
+	u32 want = (u32)bytes;
+	struct capture_policy_t *cpol = bpf_map_lookup_elem(&capture_policy, &pf_key);
+	if (cpol) {
+		if (cpol->max_capture && want > cpol->max_capture)
+			want = cpol->max_capture;
+		if (cpol->sample_n > 1) {
+			u64 *cnt = bpf_map_lookup_elem(&sample_counters, &pf_key);
+			if (cnt) {
+				*cnt += 1;
+				if (*cnt % cpol->sample_n)
+					want = 0; // unsampled — 메타데이터만 내보낸다
+			}
+		}
 	}
-	event->_pad = 0;
 
-	u32 copy = (u32)bytes;
-	if (copy > MAX_MSG_SIZE)
-		copy = MAX_MSG_SIZE;
-	copy &= (MAX_MSG_SIZE - 1);
-	bpf_probe_read_user(&event->msg, copy + 1, (void *)a->buf);
+	// Header-only 레코드: 페이로드 없이 고정 헤더만 reserve한다.
+	// msg_size/latency 등 메타데이터는 그대로 실리므로 집계는 깨지지 않는다.
+	if (want == 0) {
+		struct data_event_t *event = bpf_ringbuf_reserve(
+			&events, sizeof(*event), 0);
+		if (!event) {
+			stat_add(STAT_RESERVE_FAIL, 1);
+			return 0;
+		}
+		fill_event_hdr(event, a, bytes, direction,
+			       proto, mtype, pid, conn_key, latency_ns);
+		event->cap_len = 0;
+		bpf_ringbuf_submit(event, submit_flags());
+		stat_add(STAT_SUBMITTED, 1);
+		return 0;
+	}
 
-	bpf_ringbuf_submit(event, 0);
+	// ── Phase 2: variable-length ringbuf record (header + bucketed payload) ──
+	if (want < EVENT_BUCKET_SMALL)
+		EMIT_SIZED(EVENT_BUCKET_SMALL);
+	else if (want < EVENT_BUCKET_MEDIUM)
+		EMIT_SIZED(EVENT_BUCKET_MEDIUM);
+	else
+		EMIT_SIZED(MAX_MSG_SIZE);
 	return 0;
 }
 
@@ -880,6 +1293,8 @@ int tp_sys_enter_write(struct trace_event_raw_sys_enter *ctx)
 
 	if (fd <= 2)
 		return 0;
+	if (pid_filtered(pid))
+		return 0;
 
 	u64 sock_key = ((u64)pid << 32) | (u32)fd;
 	if (!bpf_map_lookup_elem(&socket_fds, &sock_key))
@@ -919,6 +1334,8 @@ int tp_sys_enter_read(struct trace_event_raw_sys_enter *ctx)
 
 	if (fd <= 2)
 		return 0;
+	if (pid_filtered(pid))
+		return 0;
 
 	u64 sock_key = ((u64)pid << 32) | (u32)fd;
 	if (!bpf_map_lookup_elem(&socket_fds, &sock_key))
@@ -956,6 +1373,9 @@ int tp_sys_enter_sendto(struct trace_event_raw_sys_enter *ctx)
 	u32 pid = id >> 32;
 	int fd  = (int)ctx->args[0];
 
+	if (pid_filtered(pid))
+		return 0;
+
 	u64 sock_key = ((u64)pid << 32) | (u32)fd;
 	u8 val = 1;
 	bpf_map_update_elem(&socket_fds, &sock_key, &val, BPF_ANY);
@@ -992,6 +1412,9 @@ int tp_sys_enter_recvfrom(struct trace_event_raw_sys_enter *ctx)
 	u32 pid = id >> 32;
 	int fd  = (int)ctx->args[0];
 
+	if (pid_filtered(pid))
+		return 0;
+
 	u64 sock_key = ((u64)pid << 32) | (u32)fd;
 	u8 val = 1;
 	bpf_map_update_elem(&socket_fds, &sock_key, &val, BPF_ANY);
@@ -1039,6 +1462,8 @@ int tp_sys_enter_recvmsg(struct trace_event_raw_sys_enter *ctx)
 
 	if (fd <= 2)
 		return 0;
+	if (pid_filtered(pid))
+		return 0;
 
 	u64 sock_key = ((u64)pid << 32) | (u32)fd;
 	if (!bpf_map_lookup_elem(&socket_fds, &sock_key))
@@ -1081,6 +1506,66 @@ int tp_sys_exit_recvmsg(struct trace_event_raw_sys_exit *ctx)
 	return 0;
 }
 
+// ─── sendmsg ─────────────────────────────────────────────────────
+// nginx와 대부분의 JVM 서버는 응답(헤더+바디 iovec)을 sendmsg()/writev()로
+// 내보낸다 — 이 둘을 잡지 않으면 해당 워크로드의 응답이 통째로 보이지
+// 않아 aggregator에 요청만 쌓인다. recvmsg와 같은 msghdr 레이아웃에서
+// iov[0].iov_base를 캡처한다: 상태줄/헤더는 관례상 첫 세그먼트에 있고,
+// msg_size는 syscall 전체 전송량을 그대로 실으므로 집계는 정확하다.
+
+SEC("tracepoint/syscalls/sys_enter_sendmsg")
+int tp_sys_enter_sendmsg(struct trace_event_raw_sys_enter *ctx)
+{
+	u64 id  = bpf_get_current_pid_tgid();
+	u32 pid = id >> 32;
+	int fd  = (int)ctx->args[0];
+
+	if (fd <= 2)
+		return 0;
+	if (pid_filtered(pid))
+		return 0;
+
+	u64 sock_key = ((u64)pid << 32) | (u32)fd;
+	if (!bpf_map_lookup_elem(&socket_fds, &sock_key))
+		return 0;
+
+	// Read msg_iov pointer from msghdr at offset 16.
+	u64 msghdr_ptr = ctx->args[1];
+	u64 iov_ptr    = 0;
+	bpf_probe_read_user(&iov_ptr, sizeof(iov_ptr),
+	                    (void *)(msghdr_ptr + 16));
+	if (!iov_ptr)
+		return 0;
+
+	// Read iov_base (first iovec, offset 0).
+	u64 buf = 0;
+	bpf_probe_read_user(&buf, sizeof(buf), (void *)iov_ptr);
+	if (!buf)
+		return 0;
+
+	struct args_t a = {};
+	a.buf = buf;
+	a.fd  = (u32)fd;
+	bpf_map_update_elem(&active_send_args, &id, &a, BPF_ANY);
+	return 0;
+}
+
+SEC("tracepoint/syscalls/sys_exit_sendmsg")
+int tp_sys_exit_sendmsg(struct trace_event_raw_sys_exit *ctx)
+{
+	u64 id = bpf_get_current_pid_tgid();
+	struct args_t *a = bpf_map_lookup_elem(&active_send_args, &id);
+	if (!a)
+		return 0;
+
+	long ret = ctx->ret;
+	if (ret > 0)
+		emit_event(a, ret, 0);
+
+	bpf_map_delete_elem(&active_send_args, &id);
+	return 0;
+}
+
 // ─── readv ───────────────────────────────────────────────────────
 // Java NIO may use readv() (scatter-gather read) for socket I/O.
 // We capture iovec[0].iov_base as the buffer pointer.
@@ -1094,6 +1579,8 @@ int tp_sys_enter_readv(struct trace_event_raw_sys_enter *ctx)
 
 	if (fd <= 2)
 		return 0;
+	if (pid_filtered(pid))
+		return 0;
 
 	u64 sock_key = ((u64)pid << 32) | (u32)fd;
 	if (!bpf_map_lookup_elem(&socket_fds, &sock_key))
@@ -1129,6 +1616,94 @@ int tp_sys_exit_readv(struct trace_event_raw_sys_exit *ctx)
 	return 0;
 }
 
+// ─── writev ──────────────────────────────────────────────────────
+// nginx는 응답 헤더와 바디를 별도 iovec으로 묶어 writev()로 내보내는
+// 것이 기본 동작이다. readv와 대칭으로 iovec[0].iov_base를 캡처한다 —
+// 상태줄/헤더가 들어있는 첫 세그먼트만 있으면 프로토콜 추론이 되고,
+// msg_size에는 ret(전체 전송량)가 실린다.
+
+SEC("tracepoint/syscalls/sys_enter_writev")
+int tp_sys_enter_writev(struct trace_event_raw_sys_enter *ctx)
+{
+	u64 id  = bpf_get_current_pid_tgid();
+	u32 pid = id >> 32;
+	int fd  = (int)ctx->args[0];
+
+	if (fd <= 2)
+		return 0;
+	if (pid_filtered(pid))
+		return 0;
+
+	u64 sock_key = ((u64)pid << 32) | (u32)fd;
+	if (!bpf_map_lookup_elem(&socket_fds, &sock_key))
+		return 0;
+
+	// iovec[0].iov_base is at offset 0 of the first iovec.
+	u64 iov_ptr = ctx->args[1];
+	u64 buf     = 0;
+	bpf_probe_read_user(&buf, sizeof(buf), (void *)iov_ptr);
+	if (!buf)
+		return 0;
+
+	struct args_t a = {};
+	a.buf = buf;
+	a.fd  = (u32)fd;
+	bpf_map_update_elem(&active_send_args, &id, &a, BPF_ANY);
+	return 0;
+}
+
+SEC("tracepoint/syscalls/sys_exit_writev")
+int tp_sys_exit_writev(struct trace_event_raw_sys_exit *ctx)
+{
+	u64 id = bpf_get_current_pid_tgid();
+	struct args_t *a = bpf_map_lookup_elem(&active_send_args, &id);
+	if (!a)
+		return 0;
+
+	long ret = ctx->ret;
+	if (ret > 0)
+		emit_event(a, ret, 0);
+
+	bpf_map_delete_elem(&active_send_args, &id);
+	return 0;
+}
+
+// ─── sched_process_exec (event-driven uprobe discovery) ─────────
+// exec 직후 PID를 전용 ringbuf로 올려 보낸다. agent가 이 이벤트를 받아
+// 해당 프로세스의 libssl / Go TLS attach 대상을 즉시 스캔하므로,
+// 주기적 /proc 전체 순회 없이도 짧게 사는 프로세스를 잡을 수 있다.
+
+struct trace_event_raw_sched_process_exec {
+	unsigned short common_type;
+	unsigned char  common_flags;
+	unsigned char  common_preempt_count;
+	int            common_pid;
+	u32            __data_loc_filename;
+	int            pid;
+	int            old_pid;
+};
+
+struct proc_event_t {
+	u32 pid;
+};
+
+// 이벤트당 4바이트 × 낮은 exec 빈도 — 작은 전용 ringbuf면 충분하다.
+struct {
+	__uint(type, BPF_MAP_TYPE_RINGBUF);
+	__uint(max_entries, 64 * 1024);
+} proc_events SEC(".maps");
+
+SEC("tracepoint/sched/sched_process_exec")
+int tp_sched_process_exec(struct trace_event_raw_sched_process_exec *ctx)
+{
+	struct proc_event_t *ev = bpf_ringbuf_reserve(&proc_events, sizeof(*ev), 0);
+	if (!ev)
+		return 0;
+	ev->pid = (u32)ctx->pid;
+	bpf_ringbuf_submit(ev, 0);
+	return 0;
+}
+
 // ─── close (cleanup) ────────────────────────────────────────────
 
 SEC("tracepoint/syscalls/sys_enter_close")
@@ -42,6 +42,18 @@ struct user_pt_regs {
 
 #define MAX_MSG_SIZE 4096
 
+// ringbuf notification flags — 오래된 uapi 헤더를 위한 fallback
+#ifndef BPF_RB_NO_WAKEUP
+#define BPF_RB_AVAIL_DATA   0
+#define BPF_RB_NO_WAKEUP    1
+#define BPF_RB_FORCE_WAKEUP 2
+#endif
+
+// Payload buckets — must match nefi_trace.c so both emitters produce the
+// same variable-length record format on the shared ring buffer.
+#define EVENT_BUCKET_SMALL  256
+#define EVENT_BUCKET_MEDIUM 1024
+
 // Protocol / message-type constants — must match nefi_trace.c and model/events.go
 #define PROTO_TLS    13
 #define MSG_UNKNOWN  0
@@ -49,7 +61,8 @@ struct user_pt_regs {
 #define MSG_RESPONSE 2
 
 // ─── data_event_t: exact same packed layout as nefi_trace.c ─────
-// Total size: 8+4+4+4+1+1+1+16+4096 = 4135 bytes
+// 55-byte header + bucketed variable-length payload. remote_ip/remote_port
+// are always 0 here (no connection info in uprobe context).
 
 struct data_event_t {
 	u64  timestamp_ns;
@@ -60,7 +73,11 @@ struct data_event_t {
 	u8   protocol;
 	u8   msg_type;  // 0 = unknown, 1 = request, 2 = response
 	char comm[16];
-	char msg[MAX_MSG_SIZE];
+	u32  remote_ip;   // 0 — unknown in uprobe context
+	u16  remote_port; // 0 — unknown in uprobe context
+	u64  latency_ns;  // 0 — pairing은 nefi_trace.c 쪽에서만 수행
+	u16  cap_len;     // payload bytes following this header
+	char msg[];       // bucket-sized flexible payload
 } __attribute__((packed));
 
 // ─── Saved-argument struct ───────────────────────────────────────
@@ -103,6 +120,48 @@ struct {
 	__type(value, struct ssl_buf_args_t);
 } active_go_tls_read_args SEC(".maps");
 
+// Adaptive wakeup 상태 — nefi_trace.c의 동명 맵으로 MapReplacements 교체되어
+// tracepoint/uprobe 이벤트가 같은 batching 정책과 타임스탬프를 공유한다.
+struct wakeup_config_t {
+	u64 data_threshold;
+	u64 interval_ns;
+};
+
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 1);
+	__type(key, u32);
+	__type(value, struct wakeup_config_t);
+} wakeup_config SEC(".maps");
+
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(max_entries, 1);
+	__type(key, u32);
+	__type(value, u64);
+} last_wakeup_ts SEC(".maps");
+
+// Hot-path 카운터 — nefi_trace.c의 동명 per-CPU 맵으로 MapReplacements 교체.
+// 슬롯 인덱스는 nefi_trace.c의 STAT_* 정의와 일치해야 한다.
+#define STAT_SUBMITTED    0
+#define STAT_RESERVE_FAIL 1
+#define STAT_BYTES        2
+#define STAT_MAX          8
+
+struct {
+	__uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+	__uint(max_entries, STAT_MAX);
+	__type(key, u32);
+	__type(value, u64);
+} bpf_stats SEC(".maps");
+
+static __always_inline void stat_add(u32 idx, u64 delta)
+{
+	u64 *v = bpf_map_lookup_elem(&bpf_stats, &idx);
+	if (v)
+		*v += delta;
+}
+
 // ─── Go register-ABI macros ──────────────────────────────────────
 //
 // Go amd64 ABI (register-based, Go 1.17+):
@@ -135,15 +194,39 @@ struct {
 
 // ─── Emit helper ─────────────────────────────────────────────────
 
-static __always_inline int emit_ssl_event(u64 buf_addr, long bytes, u8 direction)
+// submit_flags — nefi_trace.c와 동일한 adaptive wakeup 판정.
+// (batching 미설정이면 0 = 레코드마다 기본 notify)
+static __always_inline u64 submit_flags(void)
 {
-	if (bytes <= 0)
+	u32 key = 0;
+	struct wakeup_config_t *wc = bpf_map_lookup_elem(&wakeup_config, &key);
+	if (!wc || (wc->data_threshold == 0 && wc->interval_ns == 0))
 		return 0;
 
-	struct data_event_t *event = bpf_ringbuf_reserve(&events, sizeof(*event), 0);
-	if (!event)
-		return 0;
+	if (wc->data_threshold &&
+	    bpf_ringbuf_query(&events, BPF_RB_AVAIL_DATA) >= wc->data_threshold)
+		goto wake;
+
+	if (wc->interval_ns) {
+		u64 *last = bpf_map_lookup_elem(&last_wakeup_ts, &key);
+		if (last && bpf_ktime_get_ns() - *last >= wc->interval_ns)
+			goto wake;
+	}
+	return BPF_RB_NO_WAKEUP;
+
+wake: {
+	u64 now = bpf_ktime_get_ns();
+	u64 *last = bpf_map_lookup_elem(&last_wakeup_ts, &key);
+	if (last)
+		*last = now;
+	return BPF_RB_FORCE_WAKEUP;
+}
+}
 
+// fill_ssl_hdr populates the fixed header of a reserved event record.
+static __always_inline void fill_ssl_hdr(struct data_event_t *event,
+					 long bytes, u8 direction)
+{
 	u64 id  = bpf_get_current_pid_tgid();
 	u32 pid = id >> 32;
 
@@ -156,14 +239,45 @@ static __always_inline int emit_ssl_event(u64 buf_addr, long bytes, u8 direction
 	// direction=0 (send) → request; direction=1 (recv) → response
 	event->msg_type     = (direction == 0) ? MSG_REQUEST : MSG_RESPONSE;
 	bpf_get_current_comm(&event->comm, sizeof(event->comm));
+	event->remote_ip    = 0;
+	event->remote_port  = 0;
+	event->latency_ns   = 0;
+}
+
+// EMIT_SSL_SIZED: same bucketed reserve/copy/submit as EMIT_SIZED in
+// nefi_trace.c — each bucket keeps a constant reserve size for the verifier.
+#define EMIT_SSL_SIZED(SZ)						\
+	do {								\
+		struct data_event_t *event = bpf_ringbuf_reserve(	\
+			&events, sizeof(*event) + (SZ), 0);		\
+		if (!event) {						\
+			stat_add(STAT_RESERVE_FAIL, 1);			\
+			return 0;					\
+		}							\
+		fill_ssl_hdr(event, bytes, direction);			\
+		u32 copy = (u32)bytes;					\
+		if (copy >= (SZ))					\
+			copy = (SZ) - 1;				\
+		copy &= ((SZ) - 1); /* verifier: prove copy < SZ */	\
+		bpf_probe_read_user(&event->msg, copy + 1, (void *)buf_addr); \
+		event->cap_len = (u16)(copy + 1);			\
+		bpf_ringbuf_submit(event, submit_flags());		\
+		stat_add(STAT_SUBMITTED, 1);				\
+		stat_add(STAT_BYTES, copy + 1);				\
+	} while (0)
 
-	u32 copy = (u32)bytes;
-	if (copy > MAX_MSG_SIZE)
-		copy = MAX_MSG_SIZE;
-	copy &= (MAX_MSG_SIZE - 1); // verifier: prove copy < MAX_MSG_SIZE
-	bpf_probe_read_user(&event->msg, copy + 1, (void *)buf_addr);
+static __always_inline int emit_ssl_event(u64 buf_addr, long bytes, u8 direction)
+{
+	if (bytes <= 0)
+		return 0;
 
-	bpf_ringbuf_submit(event, 0);
+	u32 want = (u32)bytes;
+	if (want < EVENT_BUCKET_SMALL)
+		EMIT_SSL_SIZED(EVENT_BUCKET_SMALL);
+	else if (want < EVENT_BUCKET_MEDIUM)
+		EMIT_SSL_SIZED(EVENT_BUCKET_MEDIUM);
+	else
+		EMIT_SSL_SIZED(MAX_MSG_SIZE);
 	return 0;
 }
 
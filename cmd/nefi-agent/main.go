@@ -10,7 +10,7 @@
 //
 //   2. SSLLoader + ProcScanner 초기화
 //      → ssl_trace.c BPF 로드 (loader의 ringbuf 공유)
-//      → ProcScanner 백그라운드 고루틴 시작 (5초마다 /proc 스캔)
+//      → exec 이벤트 구독 (proc_events ringbuf) + 60초 reconciliation 스캔
 //      → 실패해도 에이전트는 계속 동작 (TLS 캡처만 비활성화)
 //
 //   3. 이벤트 루프 (for)
@@ -33,6 +33,7 @@ import (
 	"log"
 	"os"
 	"os/signal"
+	"strings"
 	"syscall"
 	"time"
 
@@ -45,14 +46,44 @@ import (
 )
 
 func main() {
-	serverAddr := flag.String("server-addr", "", "nefi-server gRPC address (e.g. nefi-server:9090); empty = stdout only")
+	serverAddr := flag.String("server-addr", "", "nefi-server gRPC address(es), comma-separated for sharded replicas (e.g. nefi-server-0:9090,nefi-server-1:9090); empty = stdout only")
+	aggMode := flag.Bool("agg-mode", false, "counters-only mode: aggregate in-kernel, no payload capture (for high-QPS nodes)")
+	mapEntries := flag.Uint("map-entries", 0, "max entries for per-connection BPF maps (0 = default 65536)")
+	captureBytes := flag.Uint("capture-bytes", 0, "payload byte cap per event (0 = full 4096)")
+	sampleN := flag.Uint("sample-n", 0, "capture payload on only 1 of N events, rest are header-only (0/1 = all)")
+	coalesce := flag.Bool("coalesce", false, "fold split-read continuation chunks in-kernel into one summary record per message (for JVM-heavy nodes)")
+	exclude := flag.String("exclude", "", "comma-separated pods to exclude from capture, as 'namespace' or 'namespace/pod-prefix' (e.g. kube-system,monitoring/node-exporter)")
+	metricsAddr := flag.String("metrics-addr", ":9101", "Prometheus /metrics listen address (empty = disabled)")
 	flag.Parse()
 
 	fmt.Println("============================================================")
 	fmt.Println("  Nefi Agent — eBPF Socket Data Capture (libbpf/CO-RE)")
 	fmt.Println("============================================================")
 
-	loader, err := agentebpf.New()
+	excludes := parseExcludes(*exclude)
+
+	// HTTP만 커널 필터를 통과시킨다 — 나머지 프로토콜은 inference 비용만 내고
+	// ringbuf 복사/wakeup 없이 커널에서 버려진다.
+	loader, err := agentebpf.New(agentebpf.Config{
+		Protocols: []model.Protocol{model.ProtoHTTP},
+		AggMode:   *aggMode,
+		Coalesce:  *coalesce,
+		// agent 자신의 트래픽(gRPC 등)은 커널에서 deny한다. 제외 대상
+		// pod의 PID는 이벤트 루프가 처음 관측할 때 lazy하게 추가된다.
+		DenyPIDs:      []uint32{uint32(os.Getpid())},
+		MapMaxEntries: uint32(*mapEntries),
+		// 캡처 정책은 현재 필터를 통과하는 HTTP에만 적용한다.
+		CapturePolicies: map[model.Protocol]agentebpf.CapturePolicy{
+			model.ProtoHTTP: {
+				MaxCaptureBytes: uint32(*captureBytes),
+				SampleN:         uint32(*sampleN),
+			},
+		},
+		// wakeup batching: 이벤트마다 깨우는 대신 128 KB가 쌓이거나
+		// 1 ms가 지났을 때만 reader를 깨운다 (ReadBatch가 한 번에 drain).
+		WakeupDataThreshold: 128 * 1024,
+		WakeupInterval:      time.Millisecond,
+	})
 	if err != nil {
 		log.Fatalf("Failed to start BPF: %v", err)
 	}
@@ -62,15 +93,30 @@ func main() {
 	fmt.Printf("[*] PID=%d\n", os.Getpid())
 
 	// SSL/TLS uprobe — graceful degradation if unavailable (e.g. non-Linux).
-	sslLoader, err := agentebpf.NewSSLLoader(loader.EventsMap())
+	sslLoader, err := agentebpf.NewSSLLoader(loader.SharedMaps())
 	if err != nil {
 		log.Printf("[WARN] SSL/TLS tracing disabled: %v", err)
 	} else {
 		defer sslLoader.Close()
-		scanner := agentebpf.NewProcScanner(sslLoader, 5*time.Second)
+		// exec 이벤트로 즉시 attach하고, 주기 스캔은 놓친 프로세스를
+		// 보정하는 느린 reconciliation으로만 돈다.
+		scanner := agentebpf.NewProcScanner(sslLoader, 60*time.Second)
+		// HTTP/2 헤더 uprobe — Go 바이너리의 hpack 인코더에서 :method/:path/:status를
+		// 캡처한다. 실패해도 HTTP/1 + TLS 캡처는 계속 동작한다.
+		http2Loader, err := agentebpf.NewHTTP2Loader(loader.SharedMaps())
+		if err != nil {
+			log.Printf("[WARN] HTTP/2 tracing disabled: %v", err)
+		} else {
+			defer http2Loader.Close()
+			scanner.EnableHTTP2(http2Loader)
+			fmt.Println("[+] HTTP/2 (gRPC) header uprobe active")
+		}
+		if err := scanner.WatchExec(loader.ProcEventsMap()); err != nil {
+			log.Printf("[WARN] exec-driven discovery disabled: %v", err)
+		}
 		scanner.Start()
 		defer scanner.Stop()
-		fmt.Println("[+] SSL/TLS uprobe active (5 s scan interval)")
+		fmt.Println("[+] SSL/TLS uprobe active (exec-driven + 60 s reconciliation)")
 	}
 
 	// K8s pod resolver — graceful degradation if not running in-cluster.
@@ -91,6 +137,46 @@ func main() {
 		fmt.Printf("[+] gRPC sender active → %s\n", *serverAddr)
 	}
 
+	// Pre-aggregation 모드: 커널 per-CPU 카운터를 1초마다 drain해서
+	// synthetic stat 이벤트로 server에 전송한다. (payload 캡처 이벤트는
+	// 커널에서 생성되지 않으므로 아래 이벤트 루프는 SSL uprobe 몫만 처리)
+	if *aggMode {
+		go func() {
+			ticker := time.NewTicker(time.Second)
+			defer ticker.Stop()
+			for range ticker.C {
+				stats, err := loader.DrainAggStats()
+				if err != nil {
+					// loader.Close() 이후의 에러는 종료 경로 — 조용히 끝낸다.
+					return
+				}
+				for i := range stats {
+					st := &stats[i]
+					namespace, podName := "", ""
+					remoteNs, remotePodName := "", ""
+					if resolver != nil {
+						if pod := resolver.Resolve(st.PID); pod != nil {
+							namespace, podName = pod.Namespace, pod.PodName
+						}
+						if st.RemoteIP != 0 {
+							if remotePod := resolver.ResolveIP(st.RemoteIP); remotePod != nil {
+								remoteNs, remotePodName = remotePod.Namespace, remotePod.PodName
+							}
+						}
+					}
+					if sender != nil {
+						sender.SendStat(st, namespace, podName, remoteNs, remotePodName)
+					}
+				}
+			}
+		}()
+		fmt.Println("[+] In-kernel pre-aggregation mode active (1 s flush)")
+	}
+
+	// /metrics — 커널/큐/캐시 drop 카운터 노출 (metrics.go)
+	metrics := &agentMetrics{loader: loader, sender: sender, resolver: resolver}
+	startMetricsServer(*metricsAddr, metrics)
+
 	fmt.Println("[*] Tracing socket I/O... Press Ctrl+C to stop.")
 	fmt.Println()
 
@@ -108,8 +194,11 @@ func main() {
 	// store를 오염시키는 것을 방지한다.
 	selfPID := uint32(os.Getpid())
 
+	// ReadBatch용 재사용 버퍼 — 이벤트당 할당 없이 ringbuf를 배치로 drain한다.
+	events := make([]model.DataEvent, 256)
+
 	for {
-		event, err := loader.Read()
+		n, err := loader.ReadBatch(events)
 
 		if err != nil {
 			if errors.Is(err, ringbuf.ErrClosed) {
@@ -119,81 +208,129 @@ func main() {
 			continue
 		}
 
-		comm := event.CommString()
+		metrics.eventsRead.Add(uint64(n))
 
-		if event.PID == selfPID {
-			continue
-		}
+		for i := range events[:n] {
+			event := &events[i]
 
-		if event.Protocol != model.ProtoHTTP {
-			continue
-		}
+			comm := event.CommString()
 
-		// Resolve local pod (by PID → cgroup → UID).
-		podLabel := comm
-		if resolver != nil {
-			if pod := resolver.Resolve(event.PID); pod != nil {
-				podLabel = pod.Namespace + "/" + pod.PodName + " | " + comm
+			if event.PID == selfPID {
+				continue
 			}
-		}
 
-		// Resolve remote pod (by remote IP → cluster-wide podsByIP).
-		remoteLabel := event.RemoteIPString()
-		remoteNs, remotePodName := "", ""
-		if resolver != nil && event.RemoteIP != 0 {
-			if remotePod := resolver.ResolveIP(event.RemoteIP); remotePod != nil {
-				remoteNs = remotePod.Namespace
-				remotePodName = remotePod.PodName
-				remoteLabel = remoteNs + "/" + remotePodName
-			} else if svc := resolver.ResolveServiceIP(event.RemoteIP); svc != nil {
-				// ClusterIP DNAT 전 주소인 경우 서비스 이름으로 레이블 설정
-				remoteNs = svc.Namespace
-				remotePodName = svc.Name
-				remoteLabel = remoteNs + "/" + remotePodName
+			// Kernel-side PID 필터의 lazy 채움: 제외 대상 pod의 이벤트를
+			// 처음 관측하면 해당 PID를 deny 목록에 넣는다 — 이후 그
+			// 프로세스의 syscall은 커널 lookup 한 번으로 끝난다.
+			// (SSL uprobe 경로는 pid_filter를 거치지 않으므로 여기서도 버린다.)
+			if len(excludes) > 0 && resolver != nil {
+				if pod := resolver.Resolve(event.PID); pod != nil && excludes.match(pod.Namespace, pod.PodName) {
+					if err := loader.DenyPID(event.PID); err != nil {
+						log.Printf("[WARN] deny pid %d: %v", event.PID, err)
+					}
+					continue
+				}
 			}
-		}
-		if event.RemotePort != 0 && remoteLabel != "" {
-			remoteLabel = fmt.Sprintf("%s:%d", remoteLabel, event.RemotePort)
-		}
 
-		// Forward to nefi-server if sender is active.
-		if sender != nil {
-			namespace, podName := "", ""
+			// HTTP/2는 uprobe가 커널에서 합성한 start-line 이벤트로 올라온다.
+			if event.Protocol != model.ProtoHTTP && event.Protocol != model.ProtoHTTP2 {
+				continue
+			}
+
+			// Resolve local pod (by PID → cgroup → UID).
+			podLabel := comm
 			if resolver != nil {
 				if pod := resolver.Resolve(event.PID); pod != nil {
-					namespace = pod.Namespace
-					podName = pod.PodName
+					podLabel = pod.Namespace + "/" + pod.PodName + " | " + comm
 				}
 			}
-			sender.Send(event, namespace, podName, remoteNs, remotePodName)
-		}
 
-		// Print event with protocol, message type, and remote endpoint.
-		dir := event.DirectionString()
-		proto := event.Protocol.String()
-		msgType := event.MsgType.String()
+			// Resolve remote pod (by remote IP → cluster-wide podsByIP).
+			remoteLabel := event.RemoteIPString()
+			remoteNs, remotePodName := "", ""
+			if resolver != nil && event.RemoteIP != 0 {
+				if remotePod := resolver.ResolveIP(event.RemoteIP); remotePod != nil {
+					remoteNs = remotePod.Namespace
+					remotePodName = remotePod.PodName
+					remoteLabel = remoteNs + "/" + remotePodName
+				} else if svc := resolver.ResolveServiceIP(event.RemoteIP); svc != nil {
+					// ClusterIP DNAT 전 주소인 경우 서비스 이름으로 레이블 설정
+					remoteNs = svc.Namespace
+					remotePodName = svc.Name
+					remoteLabel = remoteNs + "/" + remotePodName
+				}
+			}
+			if event.RemotePort != 0 && remoteLabel != "" {
+				remoteLabel = fmt.Sprintf("%s:%d", remoteLabel, event.RemotePort)
+			}
 
-		if remoteLabel != "" {
-			fmt.Printf("  %s | pid=%-6d fd=%-4d size=%-6d proto=%-7s type=%-3s [%s] ↔ %s\n",
-				dir, event.PID, event.FD, event.MsgSize, proto, msgType, podLabel, remoteLabel)
-		} else {
-			fmt.Printf("  %s | pid=%-6d fd=%-4d size=%-6d proto=%-7s type=%-3s [%s]\n",
-				dir, event.PID, event.FD, event.MsgSize, proto, msgType, podLabel)
-		}
-		payload := event.Payload()
-		if len(payload) > 0 {
-			line := make([]byte, len(payload))
-			for i, b := range payload {
-				if b >= 32 && b < 127 {
-					line[i] = b
-				} else {
-					line[i] = '.'
+			// Forward to nefi-server if sender is active.
+			if sender != nil {
+				namespace, podName := "", ""
+				if resolver != nil {
+					if pod := resolver.Resolve(event.PID); pod != nil {
+						namespace = pod.Namespace
+						podName = pod.PodName
+					}
 				}
+				sender.Send(event, namespace, podName, remoteNs, remotePodName)
+			}
+
+			// Print event with protocol, message type, and remote endpoint.
+			dir := event.DirectionString()
+			proto := event.Protocol.String()
+			msgType := event.MsgType.String()
+
+			if remoteLabel != "" {
+				fmt.Printf("  %s | pid=%-6d fd=%-4d size=%-6d proto=%-7s type=%-3s [%s] ↔ %s\n",
+					dir, event.PID, event.FD, event.MsgSize, proto, msgType, podLabel, remoteLabel)
+			} else {
+				fmt.Printf("  %s | pid=%-6d fd=%-4d size=%-6d proto=%-7s type=%-3s [%s]\n",
+					dir, event.PID, event.FD, event.MsgSize, proto, msgType, podLabel)
+			}
+			payload := event.Payload()
+			if len(payload) > 0 {
+				line := make([]byte, len(payload))
+				for i, b := range payload {
+					if b >= 32 && b < 127 {
+						line[i] = b
+					} else {
+						line[i] = '.'
+					}
+				}
+				fmt.Printf("           | %s\n", string(line))
 			}
-			fmt.Printf("           | %s\n", string(line))
-		}
 
+		}
 	}
 
 	fmt.Println("[*] Done.")
 }
+
+// excludeList는 --exclude 항목들이다. 항목은 "namespace" 전체 또는
+// "namespace/pod-prefix" 형태다.
+type excludeList []string
+
+func parseExcludes(s string) excludeList {
+	var out excludeList
+	for _, e := range strings.Split(s, ",") {
+		if e = strings.TrimSpace(e); e != "" {
+			out = append(out, e)
+		}
+	}
+	return out
+}
+
+// match는 (namespace, pod)가 제외 대상인지 판정한다.
+func (x excludeList) match(namespace, pod string) bool {
+	for _, e := range x {
+		if i := strings.IndexByte(e, '/'); i >= 0 {
+			if namespace == e[:i] && strings.HasPrefix(pod, e[i+1:]) {
+				return true
+			}
+		} else if namespace == e {
+			return true
+		}
+	}
+	return false
+}
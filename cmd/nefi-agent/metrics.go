@@ -0,0 +1,96 @@
+// metrics.go — agent /metrics 엔드포인트 (Prometheus text format)
+//
+// 왜 필요한가:
+//   agent는 세 지점에서 데이터를 조용히 잃을 수 있다:
+//     1. 커널 bpf_ringbuf_reserve 실패 (ringbuf 가득 참)
+//     2. Sender 전송 큐 가득 참 (bare default drop)
+//     3. server 쪽 slow-subscriber drop (server 메트릭 영역)
+//   장애 상황에서 "요청이 앱에서 사라졌는가, nefi에서 drop됐는가"를
+//   구분하려면 각 지점의 카운터가 밖으로 보여야 한다.
+//
+// 의존성을 늘리지 않기 위해 prometheus client 라이브러리 대신
+// text exposition format을 직접 쓴다 — counter/gauge만 있으면 충분하다.
+package main
+
+import (
+	"fmt"
+	"log"
+	"net/http"
+	"sync/atomic"
+
+	agentebpf "github.com/gihongjo/nefi/internal/agent/ebpf"
+	agentgrpc "github.com/gihongjo/nefi/internal/agent/grpc"
+	agentk8s "github.com/gihongjo/nefi/internal/agent/k8s"
+)
+
+// agentMetrics는 /metrics 핸들러가 읽는 소스들을 묶는다.
+// sender/resolver는 비활성화 구성에서 nil일 수 있다.
+type agentMetrics struct {
+	loader   *agentebpf.Loader
+	sender   *agentgrpc.Sender
+	resolver *agentk8s.Resolver
+
+	eventsRead atomic.Uint64 // ringbuf에서 userspace로 읽어낸 이벤트 수
+}
+
+// startMetricsServer는 addr에서 /metrics HTTP 서버를 시작한다 (non-blocking).
+// addr이 비어 있으면 아무것도 하지 않는다.
+func startMetricsServer(addr string, m *agentMetrics) {
+	if addr == "" {
+		return
+	}
+	mux := http.NewServeMux()
+	mux.HandleFunc("/metrics", m.serveMetrics)
+	go func() {
+		if err := http.ListenAndServe(addr, mux); err != nil {
+			log.Printf("[WARN] metrics server stopped: %v", err)
+		}
+	}()
+	fmt.Printf("[+] Metrics endpoint active → http://%s/metrics\n", addr)
+}
+
+func (m *agentMetrics) serveMetrics(w http.ResponseWriter, _ *http.Request) {
+	w.Header().Set("Content-Type", "text/plain; version=0.0.4")
+
+	writeMetric := func(name, typ, help string, value uint64) {
+		fmt.Fprintf(w, "# HELP %s %s\n# TYPE %s %s\n%s %d\n", name, help, name, typ, name, value)
+	}
+
+	// ── 커널 (bpf_stats per-CPU 맵 합산) ──
+	if st, err := m.loader.ReadBpfStats(); err == nil {
+		writeMetric("nefi_agent_bpf_events_submitted_total", "counter",
+			"Events submitted to the ring buffer by all BPF programs", st.Submitted)
+		writeMetric("nefi_agent_bpf_reserve_failures_total", "counter",
+			"bpf_ringbuf_reserve failures (events dropped in the kernel)", st.ReserveFails)
+		writeMetric("nefi_agent_bpf_payload_bytes_total", "counter",
+			"Captured payload bytes submitted to the ring buffer", st.Bytes)
+		writeMetric("nefi_agent_bpf_chunks_coalesced_total", "counter",
+			"Continuation chunks folded in the kernel instead of emitted (--coalesce)", st.Coalesced)
+	}
+
+	// ── userspace 이벤트 루프 ──
+	writeMetric("nefi_agent_ringbuf_events_read_total", "counter",
+		"Events read from the ring buffer by the agent event loop", m.eventsRead.Load())
+
+	// ── sender 큐 ──
+	if m.sender != nil {
+		depth, capacity, enqueued, drops := m.sender.Stats()
+		writeMetric("nefi_agent_sender_queue_depth", "gauge",
+			"Current events waiting in the gRPC send queue", uint64(depth))
+		writeMetric("nefi_agent_sender_queue_capacity", "gauge",
+			"Capacity of the gRPC send queue", uint64(capacity))
+		writeMetric("nefi_agent_sender_enqueued_total", "counter",
+			"Events accepted into the gRPC send queue", enqueued)
+		writeMetric("nefi_agent_sender_drops_total", "counter",
+			"Events dropped because the gRPC send queue was full", drops)
+	}
+
+	// ── resolver 캐시 ──
+	if m.resolver != nil {
+		hits, misses := m.resolver.CacheStats()
+		writeMetric("nefi_agent_resolver_cache_hits_total", "counter",
+			"PID-to-pod cache hits", hits)
+		writeMetric("nefi_agent_resolver_cache_misses_total", "counter",
+			"PID-to-pod cache misses (cgroup parse on the hot path)", misses)
+	}
+}
@@ -0,0 +1,194 @@
+// nefi-loadgen — collector 부하 생성기 (synthetic agent)
+//
+// 역할:
+//
+//	기록된 트래픽과 같은 모양의 TraceEvent 스트림(HTTP 요청/응답 쌍)을
+//	합성해 nefi-server의 NefiCollector.SendEvents로 지정한 속도로 밀어
+//	넣는다. 서버 ingest 파이프라인(collector → store → aggregator →
+//	hub)의 처리량·회귀를 실제 커널 없이 측정하는 용도다.
+//
+// 사용 예:
+//
+//	nefi-loadgen --server-addr localhost:9090 --rate 50000 --duration 30s --streams 4
+package main
+
+import (
+	"context"
+	"flag"
+	"fmt"
+	"log"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"google.golang.org/grpc"
+	"google.golang.org/grpc/credentials/insecure"
+
+	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
+)
+
+const batchSize = 256 // agent sender의 maxBatchSize와 같은 수준
+
+var (
+	methods  = []string{"GET", "GET", "GET", "POST", "PUT", "DELETE"}
+	paths    = []string{"/api/users", "/api/orders", "/api/items", "/healthz", "/api/login"}
+	statuses = []int32{200, 200, 200, 200, 201, 204, 404, 500}
+)
+
+// eventPair는 연결 하나의 요청/응답 이벤트 쌍을 합성한다.
+// collector의 connTracker/enrichment가 실제 트래픽과 동일하게 동작하도록
+// payload에 raw HTTP를 담는다.
+func eventPair(stream, seq int) (*nefiv1.TraceEvent, *nefiv1.TraceEvent) {
+	now := uint64(time.Now().UnixNano())
+	pod := fmt.Sprintf("loadgen-%d-%02d", stream, seq%16)
+	fd := uint32(100 + seq%64)
+	method := methods[seq%len(methods)]
+	path := fmt.Sprintf("%s/%d", paths[seq%len(paths)], seq%100)
+	status := statuses[seq%len(statuses)]
+
+	req := &nefiv1.TraceEvent{
+		TimestampNs: now,
+		Pid:         uint32(1000 + stream),
+		Fd:          fd,
+		Direction:   1, // recv: 서버 입장에서 요청 수신
+		Protocol:    1,
+		MsgType:     1,
+		Comm:        "loadgen",
+		Namespace:   "loadtest",
+		PodName:     pod,
+		RemoteIp:    0x0a000001 + uint32(stream),
+		RemotePort:  uint32(30000 + seq%1000),
+		Payload:     []byte(fmt.Sprintf("%s %s HTTP/1.1\r\nHost: svc\r\nContent-Type: application/json\r\n\r\n", method, path)),
+	}
+	resp := &nefiv1.TraceEvent{
+		TimestampNs: now + 2_000_000, // 2ms 뒤 응답
+		Pid:         req.Pid,
+		Fd:          fd,
+		Direction:   0, // send: 응답 송신
+		Protocol:    1,
+		MsgType:     2,
+		Comm:        req.Comm,
+		Namespace:   req.Namespace,
+		PodName:     pod,
+		RemoteIp:    req.RemoteIp,
+		RemotePort:  req.RemotePort,
+		LatencyNs:   2_000_000,
+		Payload:     []byte(fmt.Sprintf("HTTP/1.1 %d X\r\nContent-Type: application/json\r\n\r\n{}", status)),
+	}
+	return req, resp
+}
+
+// runStream은 스트림 하나로 rate events/s를 duration 동안 전송한다.
+func runStream(ctx context.Context, addr string, stream, rate int, sent *atomic.Uint64) error {
+	conn, err := grpc.NewClient(addr, grpc.WithTransportCredentials(insecure.NewCredentials()))
+	if err != nil {
+		return err
+	}
+	defer conn.Close()
+
+	st, err := nefiv1.NewNefiCollectorClient(conn).SendEvents(ctx)
+	if err != nil {
+		return err
+	}
+
+	batch := &nefiv1.TraceEventBatch{Events: make([]*nefiv1.TraceEvent, 0, batchSize)}
+	flush := func() error {
+		if len(batch.Events) == 0 {
+			return nil
+		}
+		if err := st.Send(batch); err != nil {
+			return err
+		}
+		sent.Add(uint64(len(batch.Events)))
+		batch.Events = batch.Events[:0]
+		return nil
+	}
+
+	// 10ms tick마다 rate/100개씩 생성 — 버스트 없이 고르게 민다.
+	ticker := time.NewTicker(10 * time.Millisecond)
+	defer ticker.Stop()
+	perTick := rate / 100
+	if perTick < 2 {
+		perTick = 2
+	}
+
+	seq := 0
+	for {
+		select {
+		case <-ctx.Done():
+			flush() //nolint:errcheck — 종료 중 best effort
+			if _, err := st.CloseAndRecv(); err != nil {
+				return err
+			}
+			return nil
+		case <-ticker.C:
+			for i := 0; i < perTick/2; i++ {
+				req, resp := eventPair(stream, seq)
+				seq++
+				batch.Events = append(batch.Events, req, resp)
+				if len(batch.Events) >= batchSize {
+					if err := flush(); err != nil {
+						return err
+					}
+				}
+			}
+			if err := flush(); err != nil {
+				return err
+			}
+		}
+	}
+}
+
+func main() {
+	serverAddr := flag.String("server-addr", "localhost:9090", "nefi-server gRPC address")
+	rate := flag.Int("rate", 10000, "target events/sec across all streams")
+	duration := flag.Duration("duration", 30*time.Second, "how long to generate load")
+	streams := flag.Int("streams", 1, "parallel agent streams")
+	flag.Parse()
+
+	fmt.Println("============================================================")
+	fmt.Println("  Nefi Loadgen — synthetic agent streams")
+	fmt.Println("============================================================")
+	fmt.Printf("[+] target: %s  rate: %d ev/s  streams: %d  duration: %v\n",
+		*serverAddr, *rate, *streams, *duration)
+
+	ctx, cancel := context.WithTimeout(context.Background(), *duration)
+	defer cancel()
+
+	var sent atomic.Uint64
+	start := time.Now()
+
+	var wg sync.WaitGroup
+	for i := 0; i < *streams; i++ {
+		wg.Add(1)
+		go func(stream int) {
+			defer wg.Done()
+			if err := runStream(ctx, *serverAddr, stream, *rate / *streams, &sent); err != nil && ctx.Err() == nil {
+				log.Printf("[loadgen] stream %d: %v", stream, err)
+			}
+		}(i)
+	}
+
+	// 1초마다 진행 상황 출력
+	go func() {
+		ticker := time.NewTicker(time.Second)
+		defer ticker.Stop()
+		var last uint64
+		for {
+			select {
+			case <-ctx.Done():
+				return
+			case <-ticker.C:
+				cur := sent.Load()
+				fmt.Printf("[*] sent: %d (+%d/s)\n", cur, cur-last)
+				last = cur
+			}
+		}
+	}()
+
+	wg.Wait()
+	elapsed := time.Since(start)
+	total := sent.Load()
+	fmt.Printf("[+] done: %d events in %v (%.0f ev/s achieved)\n",
+		total, elapsed.Round(time.Millisecond), float64(total)/elapsed.Seconds())
+}
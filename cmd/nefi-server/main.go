@@ -22,6 +22,8 @@ func main() {
 	flag.StringVar(&cfg.GRPCAddr, "grpc-addr", ":9090", "gRPC listen address (agent → server)")
 	flag.StringVar(&cfg.HTTPAddr, "http-addr", ":8080", "HTTP listen address (WebSocket /ws, API /api/...)")
 	flag.IntVar(&cfg.Capacity, "capacity", 10000, "in-memory ring buffer capacity")
+	flag.StringVar(&cfg.DataDir, "data-dir", "", "segment file directory for persistent event history (empty = memory only)")
+	flag.StringVar(&cfg.Peers, "peers", "", "comma-separated HTTP addresses of other collector replicas for merged stats/topology views (e.g. nefi-server-1:8080,nefi-server-2:8080)")
 	flag.Parse()
 
 	fmt.Println("============================================================")
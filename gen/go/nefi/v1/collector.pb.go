@@ -66,16 +66,64 @@ func (x *CollectSummary) GetReceived() uint64 {
 	return 0
 }
 
+// TraceEventBatch는 agent가 한 번의 Send로 묶어 보내는 이벤트 묶음이다.
+// 이벤트당 marshal/HTTP2 frame 비용을 배치 단위로 줄인다 (시간/크기 기반 flush).
+type TraceEventBatch struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Events        []*TraceEvent          `protobuf:"bytes,1,rep,name=events,proto3" json:"events,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *TraceEventBatch) Reset() {
+	*x = TraceEventBatch{}
+	mi := &file_nefi_v1_collector_proto_msgTypes[1]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *TraceEventBatch) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*TraceEventBatch) ProtoMessage() {}
+
+func (x *TraceEventBatch) ProtoReflect() protoreflect.Message {
+	mi := &file_nefi_v1_collector_proto_msgTypes[1]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use TraceEventBatch.ProtoReflect.Descriptor instead.
+func (*TraceEventBatch) Descriptor() ([]byte, []int) {
+	return file_nefi_v1_collector_proto_rawDescGZIP(), []int{1}
+}
+
+func (x *TraceEventBatch) GetEvents() []*TraceEvent {
+	if x != nil {
+		return x.Events
+	}
+	return nil
+}
+
 var File_nefi_v1_collector_proto protoreflect.FileDescriptor
 
 const file_nefi_v1_collector_proto_rawDesc = "" +
 	"\n" +
 	"\x17nefi/v1/collector.proto\x12\anefi.v1\x1a\x14nefi/v1/events.proto\",\n" +
 	"\x0eCollectSummary\x12\x1a\n" +
-	"\breceived\x18\x01 \x01(\x04R\breceived2M\n" +
-	"\rNefiCollector\x12<\n" +
+	"\breceived\x18\x01 \x01(\x04R\breceived\">\n" +
+	"\x0fTraceEventBatch\x12+\n" +
+	"\x06events\x18\x01 \x03(\v2\x13.nefi.v1.TraceEventR\x06events2R\n" +
+	"\rNefiCollector\x12A\n" +
 	"\n" +
-	"SendEvents\x12\x13.nefi.v1.TraceEvent\x1a\x17.nefi.v1.CollectSummary(\x01B/Z-github.com/gihongjo/nefi/proto/nefi/v1;nefiv1b\x06proto3"
+	"SendEvents\x12\x18.nefi.v1.TraceEventBatch\x1a\x17.nefi.v1.CollectSummary(\x01B/Z-github.com/gihongjo/nefi/proto/nefi/v1;nefiv1b\x06proto3"
 
 var (
 	file_nefi_v1_collector_proto_rawDescOnce sync.Once
@@ -89,19 +137,21 @@ func file_nefi_v1_collector_proto_rawDescGZIP() []byte {
 	return file_nefi_v1_collector_proto_rawDescData
 }
 
-var file_nefi_v1_collector_proto_msgTypes = make([]protoimpl.MessageInfo, 1)
+var file_nefi_v1_collector_proto_msgTypes = make([]protoimpl.MessageInfo, 2)
 var file_nefi_v1_collector_proto_goTypes = []any{
-	(*CollectSummary)(nil), // 0: nefi.v1.CollectSummary
-	(*TraceEvent)(nil),     // 1: nefi.v1.TraceEvent
+	(*CollectSummary)(nil),  // 0: nefi.v1.CollectSummary
+	(*TraceEventBatch)(nil), // 1: nefi.v1.TraceEventBatch
+	(*TraceEvent)(nil),      // 2: nefi.v1.TraceEvent
 }
 var file_nefi_v1_collector_proto_depIdxs = []int32{
-	1, // 0: nefi.v1.NefiCollector.SendEvents:input_type -> nefi.v1.TraceEvent
-	0, // 1: nefi.v1.NefiCollector.SendEvents:output_type -> nefi.v1.CollectSummary
-	1, // [1:2] is the sub-list for method output_type
-	0, // [0:1] is the sub-list for method input_type
-	0, // [0:0] is the sub-list for extension type_name
-	0, // [0:0] is the sub-list for extension extendee
-	0, // [0:0] is the sub-list for field type_name
+	2, // 0: nefi.v1.TraceEventBatch.events:type_name -> nefi.v1.TraceEvent
+	1, // 1: nefi.v1.NefiCollector.SendEvents:input_type -> nefi.v1.TraceEventBatch
+	0, // 2: nefi.v1.NefiCollector.SendEvents:output_type -> nefi.v1.CollectSummary
+	2, // [2:3] is the sub-list for method output_type
+	1, // [1:2] is the sub-list for method input_type
+	1, // [1:1] is the sub-list for extension type_name
+	1, // [1:1] is the sub-list for extension extendee
+	0, // [0:1] is the sub-list for field type_name
 }
 
 func init() { file_nefi_v1_collector_proto_init() }
@@ -116,7 +166,7 @@ func file_nefi_v1_collector_proto_init() {
 			GoPackagePath: reflect.TypeOf(x{}).PkgPath(),
 			RawDescriptor: unsafe.Slice(unsafe.StringData(file_nefi_v1_collector_proto_rawDesc), len(file_nefi_v1_collector_proto_rawDesc)),
 			NumEnums:      0,
-			NumMessages:   1,
+			NumMessages:   2,
 			NumExtensions: 0,
 			NumServices:   1,
 		},
@@ -27,12 +27,12 @@ const (
 // For semantics around ctx use and closing/ending streaming RPCs, please refer to https://pkg.go.dev/google.golang.org/grpc/?tab=doc#ClientConn.NewStream.
 //
 // NefiCollector는 agent에서 server로 이벤트를 스트리밍하는 서비스다.
-// agent가 client-streaming으로 이벤트를 전송하고,
+// agent가 client-streaming으로 이벤트 배치를 전송하고,
 // server는 처리 완료 후 ACK를 반환한다.
 type NefiCollectorClient interface {
 	// SendEvents: agent → server 단방향 클라이언트 스트리밍.
-	// agent가 이벤트를 스트림으로 push하고, 완료 시 CollectSummary를 받는다.
-	SendEvents(ctx context.Context, opts ...grpc.CallOption) (grpc.ClientStreamingClient[TraceEvent, CollectSummary], error)
+	// agent가 이벤트 배치를 스트림으로 push하고, 완료 시 CollectSummary를 받는다.
+	SendEvents(ctx context.Context, opts ...grpc.CallOption) (grpc.ClientStreamingClient[TraceEventBatch, CollectSummary], error)
 }
 
 type nefiCollectorClient struct {
@@ -43,30 +43,30 @@ func NewNefiCollectorClient(cc grpc.ClientConnInterface) NefiCollectorClient {
 	return &nefiCollectorClient{cc}
 }
 
-func (c *nefiCollectorClient) SendEvents(ctx context.Context, opts ...grpc.CallOption) (grpc.ClientStreamingClient[TraceEvent, CollectSummary], error) {
+func (c *nefiCollectorClient) SendEvents(ctx context.Context, opts ...grpc.CallOption) (grpc.ClientStreamingClient[TraceEventBatch, CollectSummary], error) {
 	cOpts := append([]grpc.CallOption{grpc.StaticMethod()}, opts...)
 	stream, err := c.cc.NewStream(ctx, &NefiCollector_ServiceDesc.Streams[0], NefiCollector_SendEvents_FullMethodName, cOpts...)
 	if err != nil {
 		return nil, err
 	}
-	x := &grpc.GenericClientStream[TraceEvent, CollectSummary]{ClientStream: stream}
+	x := &grpc.GenericClientStream[TraceEventBatch, CollectSummary]{ClientStream: stream}
 	return x, nil
 }
 
 // This type alias is provided for backwards compatibility with existing code that references the prior non-generic stream type by name.
-type NefiCollector_SendEventsClient = grpc.ClientStreamingClient[TraceEvent, CollectSummary]
+type NefiCollector_SendEventsClient = grpc.ClientStreamingClient[TraceEventBatch, CollectSummary]
 
 // NefiCollectorServer is the server API for NefiCollector service.
 // All implementations must embed UnimplementedNefiCollectorServer
 // for forward compatibility.
 //
 // NefiCollector는 agent에서 server로 이벤트를 스트리밍하는 서비스다.
-// agent가 client-streaming으로 이벤트를 전송하고,
+// agent가 client-streaming으로 이벤트 배치를 전송하고,
 // server는 처리 완료 후 ACK를 반환한다.
 type NefiCollectorServer interface {
 	// SendEvents: agent → server 단방향 클라이언트 스트리밍.
-	// agent가 이벤트를 스트림으로 push하고, 완료 시 CollectSummary를 받는다.
-	SendEvents(grpc.ClientStreamingServer[TraceEvent, CollectSummary]) error
+	// agent가 이벤트 배치를 스트림으로 push하고, 완료 시 CollectSummary를 받는다.
+	SendEvents(grpc.ClientStreamingServer[TraceEventBatch, CollectSummary]) error
 	mustEmbedUnimplementedNefiCollectorServer()
 }
 
@@ -77,7 +77,7 @@ type NefiCollectorServer interface {
 // pointer dereference when methods are called.
 type UnimplementedNefiCollectorServer struct{}
 
-func (UnimplementedNefiCollectorServer) SendEvents(grpc.ClientStreamingServer[TraceEvent, CollectSummary]) error {
+func (UnimplementedNefiCollectorServer) SendEvents(grpc.ClientStreamingServer[TraceEventBatch, CollectSummary]) error {
 	return status.Error(codes.Unimplemented, "method SendEvents not implemented")
 }
 func (UnimplementedNefiCollectorServer) mustEmbedUnimplementedNefiCollectorServer() {}
@@ -102,11 +102,11 @@ func RegisterNefiCollectorServer(s grpc.ServiceRegistrar, srv NefiCollectorServe
 }
 
 func _NefiCollector_SendEvents_Handler(srv interface{}, stream grpc.ServerStream) error {
-	return srv.(NefiCollectorServer).SendEvents(&grpc.GenericServerStream[TraceEvent, CollectSummary]{ServerStream: stream})
+	return srv.(NefiCollectorServer).SendEvents(&grpc.GenericServerStream[TraceEventBatch, CollectSummary]{ServerStream: stream})
 }
 
 // This type alias is provided for backwards compatibility with existing code that references the prior non-generic stream type by name.
-type NefiCollector_SendEventsServer = grpc.ClientStreamingServer[TraceEvent, CollectSummary]
+type NefiCollector_SendEventsServer = grpc.ClientStreamingServer[TraceEventBatch, CollectSummary]
 
 // NefiCollector_ServiceDesc is the grpc.ServiceDesc for NefiCollector service.
 // It's only intended for direct use with grpc.RegisterService,
@@ -47,7 +47,13 @@ type TraceEvent struct {
 	HttpStatus      int32  `protobuf:"varint,19,opt,name=http_status,json=httpStatus,proto3" json:"http_status,omitempty"`                 // 200, 404, 500, ... (0 = request or unknown)
 	HttpContentType string `protobuf:"bytes,20,opt,name=http_content_type,json=httpContentType,proto3" json:"http_content_type,omitempty"` // application/json, text/html, ...
 	// Latency (populated by server collector for HTTP response events)
-	LatencyNs     uint64 `protobuf:"varint,21,opt,name=latency_ns,json=latencyNs,proto3" json:"latency_ns,omitempty"` // request → response latency in nanoseconds (0 = unknown)
+	LatencyNs uint64 `protobuf:"varint,21,opt,name=latency_ns,json=latencyNs,proto3" json:"latency_ns,omitempty"` // request → response latency in nanoseconds (0 = unknown)
+	// Pre-aggregation mode (agent --agg-mode): synthetic stat events carry
+	// kernel-side counters instead of a payload. sample_count > 0 marks a
+	// synthetic event; latency_ns then holds the latency SUM over
+	// latency_count paired request→response samples.
+	SampleCount   uint64 `protobuf:"varint,22,opt,name=sample_count,json=sampleCount,proto3" json:"sample_count,omitempty"`    // number of kernel events this stat represents (0 = normal event)
+	LatencyCount  uint64 `protobuf:"varint,23,opt,name=latency_count,json=latencyCount,proto3" json:"latency_count,omitempty"` // number of samples included in latency_ns sum
 	unknownFields protoimpl.UnknownFields
 	sizeCache     protoimpl.SizeCache
 }
@@ -229,11 +235,25 @@ func (x *TraceEvent) GetLatencyNs() uint64 {
 	return 0
 }
 
+func (x *TraceEvent) GetSampleCount() uint64 {
+	if x != nil {
+		return x.SampleCount
+	}
+	return 0
+}
+
+func (x *TraceEvent) GetLatencyCount() uint64 {
+	if x != nil {
+		return x.LatencyCount
+	}
+	return 0
+}
+
 var File_nefi_v1_events_proto protoreflect.FileDescriptor
 
 const file_nefi_v1_events_proto_rawDesc = "" +
 	"\n" +
-	"\x14nefi/v1/events.proto\x12\anefi.v1\"\xe9\x04\n" +
+	"\x14nefi/v1/events.proto\x12\anefi.v1\"\xb1\x05\n" +
 	"\n" +
 	"TraceEvent\x12!\n" +
 	"\ftimestamp_ns\x18\x01 \x01(\x04R\vtimestampNs\x12\x10\n" +
@@ -262,7 +282,9 @@ const file_nefi_v1_events_proto_rawDesc = "" +
 	"httpStatus\x12*\n" +
 	"\x11http_content_type\x18\x14 \x01(\tR\x0fhttpContentType\x12\x1d\n" +
 	"\n" +
-	"latency_ns\x18\x15 \x01(\x04R\tlatencyNsB/Z-github.com/gihongjo/nefi/proto/nefi/v1;nefiv1b\x06proto3"
+	"latency_ns\x18\x15 \x01(\x04R\tlatencyNs\x12!\n" +
+	"\fsample_count\x18\x16 \x01(\x04R\vsampleCount\x12#\n" +
+	"\rlatency_count\x18\x17 \x01(\x04R\flatencyCountB/Z-github.com/gihongjo/nefi/proto/nefi/v1;nefiv1b\x06proto3"
 
 var (
 	file_nefi_v1_events_proto_rawDescOnce sync.Once
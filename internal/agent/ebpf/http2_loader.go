@@ -0,0 +1,199 @@
+//go:build linux
+
+// http2_loader.go — Go HTTP/2 (gRPC) uprobe 관리 (Linux 전용)
+//
+// 역할:
+//   Go 바이너리의 HPACK 인코더(hpack.(*Encoder).WriteField)에 uprobe를
+//   걸어서, TLS·HPACK 압축 이전의 평문 HTTP/2 헤더(:method/:path/:status)를
+//   커널에서 캡처한다 (bpf/http2_trace.c).
+//
+// 왜 필요한가:
+//   gRPC/HTTP/2는 헤더를 HPACK으로 압축해 보내므로 syscall 레벨이나
+//   crypto/tls uprobe로 캡처한 바이트에서는 method/path를 복원하려면
+//   유저스페이스에서 커넥션별 HPACK 동적 테이블을 따라가야 한다.
+//   WriteField는 압축 전의 (name, value) 쌍을 인자로 받기 때문에
+//   그 비용 없이 디코딩된 헤더를 얻을 수 있다.
+//
+// 출처:
+//   bpf/src/go_http2_trace.c(Pixie, BCC 스타일)의 접근을 이 트리의
+//   libbpf/CO-RE + 오프셋 기반 attach 파이프라인으로 이식한 것.
+//   원본이 요구하는 DWARF symaddrs 추출은 쓰지 않는다 — 자세한 내용은
+//   bpf/http2_trace.c 상단 주석 참고.
+//
+// 심볼 해석은 ssl_loader.go의 Go TLS 경로와 같은 방식이다:
+// .symtab → pclntab 폴백, VA → 파일 오프셋 변환, offsetCache 공유.
+// net/http의 HTTP/2 서버는 x/net을 std 안에 vendor하므로 두 심볼 이름
+// (vendored/비-vendored)을 모두 찾는다.
+
+package ebpf
+
+import (
+	"debug/elf"
+	"debug/gosym"
+	"fmt"
+	"log"
+	"sync"
+
+	ciliumebpf "github.com/cilium/ebpf"
+	"github.com/cilium/ebpf/link"
+)
+
+//go:generate go run github.com/cilium/ebpf/cmd/bpf2go -target arm64 -cc clang -cflags "-O2 -g -Wall" http2Trace ../../../bpf/http2_trace.c
+//go:generate go run github.com/cilium/ebpf/cmd/bpf2go -target amd64 -cc clang -cflags "-O2 -g -Wall" http2Trace ../../../bpf/http2_trace.c
+
+// hpackWriteFieldSymbols are the symbol names resolved for the WriteField
+// uprobe. The std net/http HTTP/2 server uses a vendored copy of x/net, so
+// a single binary can contain either (or, with a direct x/net dependency,
+// both) of these.
+var hpackWriteFieldSymbols = []string{
+	"golang.org/x/net/http2/hpack.(*Encoder).WriteField",
+	"vendor/golang.org/x/net/http2/hpack.(*Encoder).WriteField",
+}
+
+// HTTP2Loader loads the HTTP/2 header uprobe BPF program and manages
+// per-executable attachments. Like SSLLoader, it shares the main Loader's
+// events ring buffer and wakeup state via MapReplacements.
+type HTTP2Loader struct {
+	objs  http2TraceObjects
+	links []link.Link
+	mu    sync.Mutex
+	seen  map[string]bool // Go binary paths already attached
+}
+
+// NewHTTP2Loader initialises the HTTP/2 uprobe BPF program, replacing the
+// placeholder maps with the ones shared by the main Loader (Loader.SharedMaps).
+func NewHTTP2Loader(shared map[string]*ciliumebpf.Map) (*HTTP2Loader, error) {
+	opts := &ciliumebpf.CollectionOptions{
+		MapReplacements: shared,
+	}
+
+	l := &HTTP2Loader{
+		seen: make(map[string]bool),
+	}
+
+	if err := loadHttp2TraceObjects(&l.objs, opts); err != nil {
+		return nil, fmt.Errorf("loading HTTP/2 BPF objects: %w", err)
+	}
+
+	return l, nil
+}
+
+// AttachGoHTTP2 attaches the WriteField uprobe to a Go binary at each of the
+// given file offsets (one per resolved symbol — vendored and/or x/net).
+// Entry probes only: the header name/value are available at entry and no
+// return value is needed, so the Go-runtime uretprobe hazard does not apply.
+func (h *HTTP2Loader) AttachGoHTTP2(exePath string, offs []uint64) error {
+	h.mu.Lock()
+	defer h.mu.Unlock()
+
+	if h.seen[exePath] {
+		return nil
+	}
+	h.seen[exePath] = true
+
+	ex, err := link.OpenExecutable(exePath)
+	if err != nil {
+		return fmt.Errorf("open %s: %w", exePath, err)
+	}
+
+	var newLinks []link.Link
+	for _, off := range offs {
+		lnk, err := ex.Uprobe("", h.objs.UprobeHpackWriteField,
+			&link.UprobeOptions{Address: off})
+		if err != nil {
+			for _, l := range newLinks {
+				l.Close()
+			}
+			return fmt.Errorf("uprobe hpack WriteField (off=0x%x): %w", off, err)
+		}
+		newLinks = append(newLinks, lnk)
+	}
+
+	h.links = append(h.links, newLinks...)
+	log.Printf("[HTTP2] attached hpack WriteField uprobe: %s (%d offsets)", exePath, len(offs))
+	return nil
+}
+
+// Close releases all uprobe links and BPF objects.
+func (h *HTTP2Loader) Close() {
+	h.mu.Lock()
+	defer h.mu.Unlock()
+	for _, lnk := range h.links {
+		lnk.Close()
+	}
+	h.objs.Close()
+}
+
+// findHPackWriteFieldOffsets resolves the file offsets of every
+// hpack.(*Encoder).WriteField instance in a Go ELF binary, trying .symtab
+// first and falling back to pclntab for stripped binaries (same approach
+// as findGoTLSOffsets).
+func findHPackWriteFieldOffsets(path string) ([]uint64, error) {
+	f, err := elf.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+
+	vas := make(map[uint64]bool)
+	syms, symErr := f.Symbols() // stripped 바이너리면 에러 — pclntab으로 폴백
+	for _, sym := range syms {
+		for _, name := range hpackWriteFieldSymbols {
+			if sym.Name == name {
+				vas[sym.Value] = true
+			}
+		}
+	}
+
+	if len(vas) == 0 {
+		pclnVAs, pclnErr := hpackVAsFromPclntab(f)
+		if pclnErr != nil {
+			return nil, fmt.Errorf("hpack WriteField not found in %s (symtab: %v; pclntab: %v)",
+				path, symErr, pclnErr)
+		}
+		vas = pclnVAs
+	}
+
+	var offs []uint64
+	for va := range vas {
+		off, err := vaToFileOffset(f, va)
+		if err != nil {
+			return nil, fmt.Errorf("WriteField VA 0x%x → file offset: %w", va, err)
+		}
+		offs = append(offs, off)
+	}
+	return offs, nil
+}
+
+// hpackVAsFromPclntab recovers WriteField virtual addresses from .gopclntab
+// when the symbol table has been stripped.
+func hpackVAsFromPclntab(f *elf.File) (map[uint64]bool, error) {
+	pclnSec := f.Section(".gopclntab")
+	if pclnSec == nil {
+		return nil, fmt.Errorf("no .gopclntab section")
+	}
+	textSec := f.Section(".text")
+	if textSec == nil {
+		return nil, fmt.Errorf("no .text section")
+	}
+	data, err := pclnSec.Data()
+	if err != nil {
+		return nil, fmt.Errorf("reading .gopclntab: %w", err)
+	}
+
+	tab, err := gosym.NewTable(nil, gosym.NewLineTable(data, textSec.Addr))
+	if err != nil {
+		return nil, fmt.Errorf("parsing pclntab: %w", err)
+	}
+
+	vas := make(map[uint64]bool)
+	for _, name := range hpackWriteFieldSymbols {
+		if fn := tab.LookupFunc(name); fn != nil {
+			vas[fn.Entry] = true
+		}
+	}
+	if len(vas) == 0 {
+		return nil, fmt.Errorf("hpack WriteField not in pclntab")
+	}
+	return vas, nil
+}
@@ -0,0 +1,20 @@
+//go:build !linux
+
+package ebpf
+
+import (
+	"fmt"
+
+	ciliumebpf "github.com/cilium/ebpf"
+)
+
+// HTTP2Loader is a no-op stub on non-Linux platforms.
+type HTTP2Loader struct{}
+
+// NewHTTP2Loader always returns an error on non-Linux platforms.
+func NewHTTP2Loader(_ map[string]*ciliumebpf.Map) (*HTTP2Loader, error) {
+	return nil, fmt.Errorf("HTTP/2 tracing requires Linux")
+}
+
+// Close is a no-op.
+func (h *HTTP2Loader) Close() {}
@@ -16,7 +16,7 @@
 //
 //   2. Read() 반복 호출 (main.go의 루프에서)
 //      → 커널이 이벤트를 ringbuf에 쓸 때까지 블로킹
-//      → 바이너리 데이터를 model.DataEvent 구조체로 역직렬화해서 반환
+//      → 가변 길이 레코드(헤더 + bucket 페이로드)를 model.DataEvent로 파싱해서 반환
 //
 //   3. EventsMap()
 //      → ssl_loader.go(SSLLoader)가 같은 ringbuf를 공유하기 위해 맵을 가져감
@@ -27,10 +27,9 @@
 package ebpf
 
 import (
-	"bytes"
-	"encoding/binary"
 	"errors"
 	"fmt"
+	"time"
 
 	ciliumebpf "github.com/cilium/ebpf"
 	"github.com/cilium/ebpf/link"
@@ -42,22 +41,155 @@ import (
 //go:generate go run github.com/cilium/ebpf/cmd/bpf2go -target arm64 -cc clang -cflags "-O2 -g -Wall" nefiTrace ../../../bpf/nefi_trace.c
 //go:generate go run github.com/cilium/ebpf/cmd/bpf2go -target amd64 -cc clang -cflags "-O2 -g -Wall" nefiTrace ../../../bpf/nefi_trace.c
 
+// Config는 BPF 로드 시점 옵션이다.
+type Config struct {
+	// Protocols는 ringbuf로 내보낼 프로토콜 집합이다.
+	// 비어 있으면 필터가 비활성화되어 모든 프로토콜을 내보낸다.
+	Protocols []model.Protocol
+
+	// AggMode가 true면 커널이 이벤트를 ringbuf로 내보내는 대신
+	// per-CPU 카운터(agg_stats)만 갱신한다. DrainAggStats로 수거한다.
+	AggMode bool
+
+	// Coalesce가 true면 커널이 프로토콜 메시지 head 이후의 continuation
+	// chunk(큰 응답의 body 조각)를 이벤트로 내보내지 않고 byte 카운터로
+	// 접은 뒤, 다음 head에서 header-only 요약 레코드 하나로 합산한다.
+	// 작은 read를 반복하는 JVM 워크로드의 이벤트 볼륨을 크게 줄인다.
+	Coalesce bool
+
+	// DenyPIDs는 로드 직후 커널 pid_filter deny 목록에 넣을 PID들이다
+	// (agent 자신 등). 비어 있지 않으면 필터가 deny 모드로 켜지고, 이후
+	// DenyPID로 런타임에 추가할 수 있다 — 걸러진 프로세스의 syscall은
+	// 버퍼 복사 없이 커널 lookup 한 번으로 끝난다.
+	DenyPIDs []uint32
+
+	// MapMaxEntries는 per-connection LRU 맵들의 max_entries를 로드 전에
+	// 재설정한다. 0이면 C 소스의 기본값(65536)을 그대로 쓴다.
+	// 커넥션 churn이 심한 edge 노드는 키우고, 작은 노드는 줄여서
+	// 고정 커널 메모리 사용량을 노드 프로필에 맞춘다.
+	MapMaxEntries uint32
+
+	// CapturePolicies는 로드 직후 적용할 프로토콜별 캡처 정책이다.
+	// 이후에는 SetCapturePolicy로 재로드 없이 언제든 바꿀 수 있다.
+	CapturePolicies map[model.Protocol]CapturePolicy
+
+	// Adaptive wakeup batching. 커널은 기본적으로 NO_WAKEUP으로 제출하고,
+	// 미소비 데이터가 WakeupDataThreshold 바이트를 넘거나 마지막 wakeup
+	// 이후 WakeupInterval이 지나면 FORCE_WAKEUP으로 reader를 깨운다.
+	// 둘 다 0이면 batching 비활성 — 레코드마다 깨우는 기존 동작.
+	WakeupDataThreshold uint64
+	WakeupInterval      time.Duration
+}
+
+// wakeupConfig는 BPF struct wakeup_config_t의 레이아웃과 일치해야 한다.
+type wakeupConfig struct {
+	DataThreshold uint64
+	IntervalNs    uint64
+}
+
+// CapturePolicy는 프로토콜 하나의 페이로드 캡처 정책이다.
+// 레이아웃은 BPF struct capture_policy_t와 일치해야 한다.
+type CapturePolicy struct {
+	MaxCaptureBytes uint32 // 페이로드 byte cap (0 = MAX_MSG_SIZE까지 전부)
+	SampleN         uint32 // N개 중 1개만 페이로드 캡처 (0/1 = 전부); 나머지는 header-only
+}
+
+// connMapNames는 Config.MapMaxEntries로 크기를 조정하는 per-connection
+// LRU 맵들이다. 이름은 nefi_trace.c의 SEC(".maps") 심볼과 일치해야 한다.
+var connMapNames = []string{
+	"socket_fds",
+	"active_send_args",
+	"active_recv_args",
+	"conn_state",
+	"conn_info",
+	"active_accept_args",
+}
+
 // Loader manages the BPF program lifecycle: load, attach, read events.
 type Loader struct {
 	objs   nefiTraceObjects
 	links  []link.Link
 	reader *ringbuf.Reader
+	record ringbuf.Record // ReadBatch 전용 재사용 버퍼
 }
 
 // New loads the BPF objects, attaches tracepoints, and opens the ring buffer.
-func New() (*Loader, error) {
+func New(cfg Config) (*Loader, error) {
 	var objs nefiTraceObjects
-	if err := loadNefiTraceObjects(&objs, nil); err != nil {
+	if cfg.MapMaxEntries > 0 {
+		// 맵 크기 재설정은 스펙 단계에서만 가능하므로 LoadAndAssign 경로를 쓴다.
+		spec, err := loadNefiTrace()
+		if err != nil {
+			return nil, fmt.Errorf("loading BPF spec: %w", err)
+		}
+		for _, name := range connMapNames {
+			if m, ok := spec.Maps[name]; ok {
+				m.MaxEntries = cfg.MapMaxEntries
+			}
+		}
+		if err := spec.LoadAndAssign(&objs, nil); err != nil {
+			return nil, fmt.Errorf("loading BPF objects: %w", err)
+		}
+	} else if err := loadNefiTraceObjects(&objs, nil); err != nil {
 		return nil, fmt.Errorf("loading BPF objects: %w", err)
 	}
 
 	l := &Loader{objs: objs}
 
+	if err := l.applyProtocolFilter(cfg.Protocols); err != nil {
+		objs.Close()
+		return nil, fmt.Errorf("populating protocol filter: %w", err)
+	}
+
+	if cfg.AggMode {
+		var on uint8 = 1
+		if err := objs.AggMode.Put(uint32(0), on); err != nil {
+			objs.Close()
+			return nil, fmt.Errorf("enabling agg mode: %w", err)
+		}
+	}
+
+	if cfg.Coalesce {
+		var on uint8 = 1
+		if err := objs.CoalesceMode.Put(uint32(0), on); err != nil {
+			objs.Close()
+			return nil, fmt.Errorf("enabling coalesce mode: %w", err)
+		}
+	}
+
+	if len(cfg.DenyPIDs) > 0 {
+		// 모드보다 목록을 먼저 채워 필터가 켜지는 순간부터 완전해야 한다.
+		for _, pid := range cfg.DenyPIDs {
+			if err := l.DenyPID(pid); err != nil {
+				objs.Close()
+				return nil, err
+			}
+		}
+		var mode uint8 = pidFilterDeny
+		if err := objs.PidFilterMode.Put(uint32(0), mode); err != nil {
+			objs.Close()
+			return nil, fmt.Errorf("enabling pid filter: %w", err)
+		}
+	}
+
+	for p, pol := range cfg.CapturePolicies {
+		if err := l.SetCapturePolicy(p, pol); err != nil {
+			objs.Close()
+			return nil, fmt.Errorf("setting capture policy: %w", err)
+		}
+	}
+
+	if cfg.WakeupDataThreshold > 0 || cfg.WakeupInterval > 0 {
+		wc := wakeupConfig{
+			DataThreshold: cfg.WakeupDataThreshold,
+			IntervalNs:    uint64(cfg.WakeupInterval.Nanoseconds()),
+		}
+		if err := objs.WakeupConfig.Put(uint32(0), wc); err != nil {
+			objs.Close()
+			return nil, fmt.Errorf("setting wakeup config: %w", err)
+		}
+	}
+
 	if err := l.attach(); err != nil {
 		objs.Close()
 		return nil, fmt.Errorf("attaching tracepoints: %w", err)
@@ -73,6 +205,30 @@ func New() (*Loader, error) {
 	return l, nil
 }
 
+// applyProtocolFilter는 protocol_filter 맵을 채운다.
+// 커널은 값이 1인 프로토콜만 ringbuf로 내보낸다 (나머지는 inference 비용만 지불).
+func (l *Loader) applyProtocolFilter(protocols []model.Protocol) error {
+	var allowed [16]uint8
+	if len(protocols) == 0 {
+		// 필터 미지정 → 전부 통과 (stdout 디버깅 등 기존 동작 유지)
+		for i := range allowed {
+			allowed[i] = 1
+		}
+	} else {
+		for _, p := range protocols {
+			if int(p) < len(allowed) {
+				allowed[p] = 1
+			}
+		}
+	}
+	for i, v := range allowed {
+		if err := l.objs.ProtocolFilter.Put(uint32(i), v); err != nil {
+			return fmt.Errorf("protocol_filter[%d]: %w", i, err)
+		}
+	}
+	return nil
+}
+
 // attach hooks all BPF programs to their respective tracepoints.
 func (l *Loader) attach() error {
 	type entry struct {
@@ -100,10 +256,18 @@ func (l *Loader) attach() error {
 		// recvmsg: Java NIO (Tomcat/Spring Boot) may use this instead of read()
 		{"syscalls", "sys_enter_recvmsg", l.objs.TpSysEnterRecvmsg},
 		{"syscalls", "sys_exit_recvmsg", l.objs.TpSysExitRecvmsg},
+		// sendmsg: vectored send used by JVM servers and some proxies
+		{"syscalls", "sys_enter_sendmsg", l.objs.TpSysEnterSendmsg},
+		{"syscalls", "sys_exit_sendmsg", l.objs.TpSysExitSendmsg},
 		// readv: scatter-gather read used by some Java NIO implementations
 		{"syscalls", "sys_enter_readv", l.objs.TpSysEnterReadv},
 		{"syscalls", "sys_exit_readv", l.objs.TpSysExitReadv},
+		// writev: header+body iovec 응답 — nginx 기본 송신 경로
+		{"syscalls", "sys_enter_writev", l.objs.TpSysEnterWritev},
+		{"syscalls", "sys_exit_writev", l.objs.TpSysExitWritev},
 		{"syscalls", "sys_enter_close", l.objs.TpSysEnterClose},
+		// exec 알림 — ProcScanner의 event-driven uprobe 발견 경로
+		{"sched", "sched_process_exec", l.objs.TpSchedProcessExec},
 	}
 
 	for _, e := range entries {
@@ -130,11 +294,107 @@ func (l *Loader) Read() (*model.DataEvent, error) {
 		return nil, fmt.Errorf("reading ring buffer: %w", err)
 	}
 
-	var event model.DataEvent
-	if err := binary.Read(bytes.NewReader(record.RawSample), binary.LittleEndian, &event); err != nil {
+	event, err := model.DecodeDataEvent(record.RawSample)
+	if err != nil {
 		return nil, fmt.Errorf("parsing event: %w", err)
 	}
-	return &event, nil
+	return event, nil
+}
+
+// ReadBatch는 현재 ringbuf에서 읽을 수 있는 레코드를 최대 len(events)개까지
+// events[:n]에 디코딩하고 n을 반환한다. 첫 레코드는 블로킹으로 기다리고,
+// 이후에는 버퍼가 빌 때까지 non-blocking으로 drain한다.
+//
+// events 슬라이스 원소와 각 원소의 Msg 버퍼는 호출 간 재사용되므로
+// Read()와 달리 이벤트당 할당이 없다. 반환된 이벤트를 다음 ReadBatch 호출
+// 이후까지 보관하려면 호출자가 복사해야 한다.
+func (l *Loader) ReadBatch(events []model.DataEvent) (int, error) {
+	if len(events) == 0 {
+		return 0, nil
+	}
+
+	// 첫 레코드: 블로킹 대기 (deadline 해제)
+	l.reader.SetDeadline(time.Time{})
+	if err := l.reader.ReadInto(&l.record); err != nil {
+		if errors.Is(err, ringbuf.ErrClosed) {
+			return 0, err
+		}
+		return 0, fmt.Errorf("reading ring buffer: %w", err)
+	}
+	if err := model.DecodeDataEventInto(&events[0], l.record.RawSample); err != nil {
+		return 0, fmt.Errorf("parsing event: %w", err)
+	}
+	n := 1
+
+	// 나머지: 과거 deadline으로 non-blocking drain — 버퍼가 비면 즉시 리턴
+	l.reader.SetDeadline(time.Unix(1, 0))
+	for n < len(events) {
+		if err := l.reader.ReadInto(&l.record); err != nil {
+			// ErrClosed 등 다른 에러는 다음 호출의 블로킹 Read에서 드러난다.
+			break
+		}
+		if err := model.DecodeDataEventInto(&events[n], l.record.RawSample); err != nil {
+			continue // 깨진 레코드는 skip
+		}
+		n++
+	}
+	return n, nil
+}
+
+// aggKey/aggVal은 BPF agg_key_t/agg_stat_t의 메모리 레이아웃과 일치해야 한다.
+type aggKey struct {
+	Pid      uint32
+	RemoteIP uint32
+	Protocol uint8
+	MsgType  uint8
+	_        uint16 // C 쪽 명시적 패딩과 대응
+}
+
+type aggVal struct {
+	Count        uint64
+	Bytes        uint64
+	LatencySumNs uint64
+	LatencyCount uint64
+}
+
+// DrainAggStats는 agg_stats 맵의 모든 엔트리를 per-CPU 합산해 반환하고
+// 맵에서 삭제한다. pre-aggregation 모드에서 1초 주기로 호출된다.
+func (l *Loader) DrainAggStats() ([]model.AggStat, error) {
+	var (
+		key  aggKey
+		vals []aggVal // per-CPU 값 슬라이스
+		keys []aggKey
+	)
+	stats := make([]model.AggStat, 0, 64)
+
+	it := l.objs.AggStats.Iterate()
+	for it.Next(&key, &vals) {
+		s := model.AggStat{
+			PID:      key.Pid,
+			RemoteIP: key.RemoteIP,
+			Protocol: model.Protocol(key.Protocol),
+			MsgType:  model.MsgType(key.MsgType),
+		}
+		for _, v := range vals {
+			s.Count += v.Count
+			s.Bytes += v.Bytes
+			s.LatencySumNs += v.LatencySumNs
+			s.LatencyCount += v.LatencyCount
+		}
+		stats = append(stats, s)
+		keys = append(keys, key)
+	}
+	if err := it.Err(); err != nil {
+		return nil, fmt.Errorf("iterating agg stats: %w", err)
+	}
+
+	// Iterate 도중 삭제하면 순서가 깨지므로 모아서 삭제한다.
+	// 삭제 직전에 커널이 증가시킨 분량은 다음 drain에 포함되지 못하고
+	// 유실될 수 있다 — 집계 용도로는 허용 가능한 오차.
+	for i := range keys {
+		_ = l.objs.AggStats.Delete(&keys[i])
+	}
+	return stats, nil
 }
 
 // EventsMap returns the shared ring buffer map so that SSLLoader can route
@@ -143,6 +403,87 @@ func (l *Loader) EventsMap() *ciliumebpf.Map {
 	return l.objs.Events
 }
 
+// ProcEventsMap returns the exec-notification ring buffer so that
+// ProcScanner can react to process starts instead of polling /proc.
+func (l *Loader) ProcEventsMap() *ciliumebpf.Map {
+	return l.objs.ProcEvents
+}
+
+// SetCapturePolicy는 프로토콜 하나의 캡처 정책을 갱신한다.
+// ARRAY 맵 쓰기라 BPF 오브젝트 재로드 없이 다음 이벤트부터 바로 반영된다.
+func (l *Loader) SetCapturePolicy(p model.Protocol, pol CapturePolicy) error {
+	if int(p) >= 16 {
+		return fmt.Errorf("protocol %d out of capture policy range", p)
+	}
+	if err := l.objs.CapturePolicy.Put(uint32(p), pol); err != nil {
+		return fmt.Errorf("capture_policy[%d]: %w", p, err)
+	}
+	return nil
+}
+
+// pid_filter_mode 값 — nefi_trace.c의 PID_FILTER_* 정의와 일치해야 한다.
+const (
+	pidFilterDeny uint8 = 1
+)
+
+// DenyPID는 PID 하나를 커널 deny 목록에 추가한다. HASH 맵 쓰기라 재로드
+// 없이 해당 프로세스의 다음 syscall부터 바로 걸러진다. main.go가 제외
+// 대상 pod의 이벤트를 처음 봤을 때 호출한다 (lazy 채움).
+func (l *Loader) DenyPID(pid uint32) error {
+	var one uint8 = 1
+	if err := l.objs.PidFilter.Put(pid, one); err != nil {
+		return fmt.Errorf("pid_filter[%d]: %w", pid, err)
+	}
+	return nil
+}
+
+// SharedMaps는 SSLLoader가 MapReplacements로 교체해 갈 공유 맵 집합이다.
+// events ringbuf에 더해 adaptive wakeup 상태까지 공유해야 tracepoint와
+// uprobe 이벤트가 같은 batching 정책으로 reader를 깨운다. bpf_stats도
+// 공유해서 모든 BPF 오브젝트의 submit/drop이 한 카운터 집합에 모인다.
+func (l *Loader) SharedMaps() map[string]*ciliumebpf.Map {
+	return map[string]*ciliumebpf.Map{
+		"events":         l.objs.Events,
+		"wakeup_config":  l.objs.WakeupConfig,
+		"last_wakeup_ts": l.objs.LastWakeupTs,
+		"bpf_stats":      l.objs.BpfStats,
+	}
+}
+
+// BpfStats는 bpf_stats per-CPU 맵의 합산 스냅샷이다. 커널 기준의 누적
+// 카운터이므로 Prometheus counter로 그대로 노출할 수 있다.
+type BpfStats struct {
+	Submitted    uint64 // ringbuf에 제출된 이벤트 수
+	ReserveFails uint64 // bpf_ringbuf_reserve 실패 (= 커널에서 drop된 이벤트 수)
+	Bytes        uint64 // 제출된 payload 바이트 합
+	Coalesced    uint64 // coalesce 모드로 접혀 ringbuf를 건너뛴 chunk 수
+}
+
+// ReadBpfStats는 bpf_stats 맵을 per-CPU 합산해 반환한다.
+// 슬롯 인덱스는 nefi_trace.c의 STAT_* 정의와 일치해야 한다.
+func (l *Loader) ReadBpfStats() (BpfStats, error) {
+	var st BpfStats
+	slots := []struct {
+		idx  uint32
+		dest *uint64
+	}{
+		{0, &st.Submitted},
+		{1, &st.ReserveFails},
+		{2, &st.Bytes},
+		{3, &st.Coalesced},
+	}
+	for _, s := range slots {
+		var vals []uint64
+		if err := l.objs.BpfStats.Lookup(s.idx, &vals); err != nil {
+			return st, fmt.Errorf("bpf_stats[%d]: %w", s.idx, err)
+		}
+		for _, v := range vals {
+			*s.dest += v
+		}
+	}
+	return st, nil
+}
+
 // Close releases all BPF resources.
 func (l *Loader) Close() {
 	if l.reader != nil {
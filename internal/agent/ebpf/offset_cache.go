@@ -0,0 +1,124 @@
+//go:build linux
+
+// offset_cache.go — Go TLS uprobe 오프셋의 on-disk 캐시
+//
+// 왜 필요한가:
+//   findGoTLSOffsets는 Go 바이너리의 심볼 테이블 전체를 읽는다. 큰 서비스
+//   바이너리(80–200 MB)에서는 수백 ms가 걸리는데, DaemonSet 롤아웃으로
+//   agent가 재시작될 때마다 같은 바이너리를 처음부터 다시 파싱하고 있었다.
+//   해석 결과를 디스크에 남겨 두면 warm 노드에서의 재시작은 JSON 한 번
+//   읽는 비용으로 끝난다.
+//
+// 무효화:
+//   엔트리는 (inode, size, mtime)으로 검증한다. 바이너리가 교체되면
+//   세 값 중 하나는 반드시 달라지므로 stale 오프셋으로 attach하지 않는다.
+//
+// negative cache:
+//   crypto/tls 심볼이 없는 바이너리(비-Go, TLS 미사용)도 NotGoTLS로
+//   기록해 스캔 주기마다 같은 실패 파싱을 반복하지 않는다.
+
+package ebpf
+
+import (
+	"encoding/json"
+	"os"
+	"path/filepath"
+	"sync"
+	"syscall"
+)
+
+// defaultOffsetCachePath는 노드 로컬 캐시 파일 경로다.
+// /var/run은 노드 재부팅 시 비워지므로 바이너리 교체 감지 실패의
+// 최악 케이스도 재부팅이면 리셋된다.
+const defaultOffsetCachePath = "/var/run/nefi/gotls-offsets.json"
+
+// cachedOffsets는 바이너리 하나의 해석 결과다.
+type cachedOffsets struct {
+	Inode       uint64   `json:"inode"`
+	Size        int64    `json:"size"`
+	ModTimeNs   int64    `json:"mod_time_ns"`
+	WriteOff    uint64   `json:"write_off"`
+	ReadOff     uint64   `json:"read_off"`
+	ReadRetOffs []uint64 `json:"read_ret_offs"`
+	NotGoTLS    bool     `json:"not_go_tls,omitempty"` // 심볼 없음 — 재파싱 불필요
+	HTTP2Offs   []uint64 `json:"http2_offs,omitempty"` // hpack WriteField 오프셋 (없으면 비-HTTP/2)
+}
+
+// offsetCache는 경로 → cachedOffsets 맵을 JSON 파일로 유지한다.
+// 쓰기는 write-through(임시 파일 + rename)라 중간에 죽어도 파일이 깨지지 않는다.
+type offsetCache struct {
+	path    string
+	mu      sync.Mutex
+	entries map[string]cachedOffsets
+}
+
+// newOffsetCache는 path의 기존 캐시를 로드한다. 파일이 없거나 깨져 있으면
+// 빈 캐시로 시작한다 (캐시는 항상 best-effort).
+func newOffsetCache(path string) *offsetCache {
+	c := &offsetCache{
+		path:    path,
+		entries: make(map[string]cachedOffsets),
+	}
+	data, err := os.ReadFile(path)
+	if err == nil {
+		// 파싱 실패 시 entries는 부분적으로 채워질 수 있으나 검증 단계에서 걸러진다.
+		_ = json.Unmarshal(data, &c.entries)
+		if c.entries == nil {
+			c.entries = make(map[string]cachedOffsets)
+		}
+	}
+	return c
+}
+
+// get은 exePath의 캐시 엔트리를 반환한다. (inode, size, mtime)이 현재
+// 파일과 다르면 miss로 처리한다.
+func (c *offsetCache) get(exePath string, fi os.FileInfo) (cachedOffsets, bool) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	ent, ok := c.entries[exePath]
+	if !ok {
+		return cachedOffsets{}, false
+	}
+	st, ok := fi.Sys().(*syscall.Stat_t)
+	if !ok {
+		return cachedOffsets{}, false
+	}
+	if ent.Inode != st.Ino || ent.Size != fi.Size() || ent.ModTimeNs != fi.ModTime().UnixNano() {
+		return cachedOffsets{}, false
+	}
+	return ent, true
+}
+
+// put은 해석 결과를 기록하고 디스크에 저장한다.
+func (c *offsetCache) put(exePath string, fi os.FileInfo, ent cachedOffsets) {
+	st, ok := fi.Sys().(*syscall.Stat_t)
+	if !ok {
+		return
+	}
+	ent.Inode = st.Ino
+	ent.Size = fi.Size()
+	ent.ModTimeNs = fi.ModTime().UnixNano()
+
+	c.mu.Lock()
+	c.entries[exePath] = ent
+	c.save()
+	c.mu.Unlock()
+}
+
+// save는 캐시를 임시 파일에 쓴 뒤 rename한다. 호출자가 mu를 잡고 있어야 한다.
+// 실패해도 in-memory 캐시는 유효하므로 에러는 무시한다.
+func (c *offsetCache) save() {
+	data, err := json.Marshal(c.entries)
+	if err != nil {
+		return
+	}
+	if err := os.MkdirAll(filepath.Dir(c.path), 0o755); err != nil {
+		return
+	}
+	tmp := c.path + ".tmp"
+	if err := os.WriteFile(tmp, data, 0o644); err != nil {
+		return
+	}
+	_ = os.Rename(tmp, c.path)
+}
@@ -22,26 +22,36 @@
 //     - AttachGoTLS(path, writeOff, readOff): Go 바이너리에 파일 오프셋 기반 uprobe 연결
 //
 //   ProcScanner
-//     - 5초마다 /proc 디렉토리를 순회하며 새로운 프로세스를 감지한다.
+//     - event-driven 경로: nefi_trace.c의 sched_process_exec 이벤트를 구독해
+//       exec 직후 해당 PID만 즉시 스캔한다 (WatchExec).
+//       짧게 살다 죽는 프로세스도 놓치지 않는다.
+//     - 주기 스캔은 느린 reconciliation으로 남는다: exec 이벤트를 놓친
+//       경우(ringbuf drop, agent 시작 전부터 있던 프로세스)를 보정한다.
 //     - /proc/<pid>/maps → "libssl" 포함 줄 → AttachOpenSSL()
 //     - /proc/<pid>/exe  → Go 바이너리 감지 → findGoTLSOffsets() → AttachGoTLS()
+//     - EnableHTTP2() 호출 시 같은 ELF 파싱에서 hpack WriteField 오프셋도
+//       해석해 HTTP2Loader에 attach한다 (http2_loader.go).
 //     - 이미 처리한 경로는 seenSSL/seenGoTLS 맵으로 중복 처리를 방지한다.
-//     - 에이전트 시작 후 새로 뜨는 프로세스도 커버하기 위해 주기적으로 실행한다.
 //
 //   findGoTLSOffsets(path)
 //     - Go 바이너리의 ELF .symtab에서 crypto/tls.(*Conn).Write / .Read 심볼을 찾는다.
+//     - stripped 바이너리는 pclntab(.gopclntab)으로 폴백한다 — Go 런타임이
+//       스택 트레이스에 쓰는 테이블이라 strip으로 제거되지 않는다.
 //     - ELF 가상 주소(VA)를 uprobe에 필요한 파일 오프셋으로 변환한다.
-//     - stripped 바이너리(심볼 테이블 없음)이면 에러를 반환하고 조용히 skip된다.
+//     - 해석 결과는 offsetCache(offset_cache.go)에 on-disk로 남겨서
+//       agent 재시작 시 큰 바이너리의 심볼 재파싱을 건너뛴다.
 //
 // 한계:
-//   stripped Go 바이너리는 .symtab이 없어 crypto/tls 심볼을 찾지 못한다.
-//   (해결 방향: pclntab 파싱으로 대체)
+//   .gopclntab 섹션이 별도로 없는 빌드(PIE 등)에서 .symtab까지 strip된
+//   경우에는 여전히 crypto/tls 심볼을 찾지 못하고 skip된다.
 
 package ebpf
 
 import (
 	"bufio"
 	"debug/elf"
+	"debug/gosym"
+	"encoding/binary"
 	"fmt"
 	"log"
 	"os"
@@ -51,6 +61,7 @@ import (
 
 	ciliumebpf "github.com/cilium/ebpf"
 	"github.com/cilium/ebpf/link"
+	"github.com/cilium/ebpf/ringbuf"
 )
 
 //go:generate go run github.com/cilium/ebpf/cmd/bpf2go -target arm64 -cc clang -cflags "-O2 -g -Wall" sslTrace ../../../bpf/ssl_trace.c
@@ -68,12 +79,11 @@ type SSLLoader struct {
 }
 
 // NewSSLLoader initialises the SSL uprobe BPF programs, replacing the
-// placeholder `events` ring buffer with the one shared by the main Loader.
-func NewSSLLoader(sharedEvents *ciliumebpf.Map) (*SSLLoader, error) {
+// placeholder maps (events ring buffer + adaptive wakeup state) with the
+// ones shared by the main Loader (Loader.SharedMaps).
+func NewSSLLoader(shared map[string]*ciliumebpf.Map) (*SSLLoader, error) {
 	opts := &ciliumebpf.CollectionOptions{
-		MapReplacements: map[string]*ciliumebpf.Map{
-			"events": sharedEvents,
-		},
+		MapReplacements: shared,
 	}
 
 	l := &SSLLoader{
@@ -228,12 +238,17 @@ func (s *SSLLoader) Close() {
 
 // ─── ProcScanner ────────────────────────────────────────────────
 
-// ProcScanner periodically walks /proc to discover new libssl.so and Go
-// binary instances, then attaches the corresponding uprobes via SSLLoader.
+// ProcScanner discovers libssl.so and Go binary instances and attaches the
+// corresponding uprobes via SSLLoader. Discovery is event-driven (exec
+// tracepoint via WatchExec); the periodic /proc walk remains as a slow
+// reconciliation pass for processes whose exec event was missed.
 type ProcScanner struct {
-	loader   *SSLLoader
-	interval time.Duration
-	stopCh   chan struct{}
+	loader     *SSLLoader
+	http2      *HTTP2Loader // nil이면 HTTP/2 uprobe 비활성화
+	interval   time.Duration
+	stopCh     chan struct{}
+	execReader *ringbuf.Reader // nil이면 event-driven 경로 비활성화
+	cache      *offsetCache    // Go 심볼 오프셋 on-disk 캐시 (TLS + HTTP/2)
 }
 
 // NewProcScanner creates a scanner that calls loader every interval.
@@ -242,17 +257,63 @@ func NewProcScanner(l *SSLLoader, interval time.Duration) *ProcScanner {
 		loader:   l,
 		interval: interval,
 		stopCh:   make(chan struct{}),
+		cache:    newOffsetCache(defaultOffsetCachePath),
 	}
 }
 
+// EnableHTTP2 registers an HTTP2Loader so the scanner also resolves and
+// attaches hpack WriteField uprobes on each Go binary it discovers.
+// Start() 이전에 호출해야 한다 (scanExeForGoTLS가 seen 마킹을 공유하므로
+// 중간에 켜면 이미 스캔한 바이너리는 건너뛴다).
+func (p *ProcScanner) EnableHTTP2(h *HTTP2Loader) {
+	p.http2 = h
+}
+
 // Start launches the background scan goroutine (non-blocking).
 func (p *ProcScanner) Start() {
 	go p.run()
 }
 
-// Stop signals the background goroutine to exit.
+// Stop signals the background goroutines to exit.
 func (p *ProcScanner) Stop() {
 	close(p.stopCh)
+	if p.execReader != nil {
+		p.execReader.Close() // watchExec의 블로킹 Read를 깨운다
+	}
+}
+
+// WatchExec는 nefi_trace.c의 proc_events ringbuf를 구독해 exec가 일어난
+// PID만 즉시 스캔하는 고루틴을 시작한다. Start() 이전에 호출해야 한다.
+func (p *ProcScanner) WatchExec(procEvents *ciliumebpf.Map) error {
+	rd, err := ringbuf.NewReader(procEvents)
+	if err != nil {
+		return fmt.Errorf("opening proc events ring buffer: %w", err)
+	}
+	p.execReader = rd
+	go p.watchExec()
+	return nil
+}
+
+func (p *ProcScanner) watchExec() {
+	selfPID := fmt.Sprintf("%d", os.Getpid())
+	for {
+		record, err := p.execReader.Read()
+		if err != nil {
+			// Stop()이 reader를 닫으면 ErrClosed로 빠져나온다.
+			return
+		}
+		if len(record.RawSample) < 4 {
+			continue
+		}
+		pid := fmt.Sprintf("%d", binary.LittleEndian.Uint32(record.RawSample[:4]))
+		if pid == selfPID {
+			continue
+		}
+		// exec 직후에는 동적 링커가 libssl을 아직 map하지 않았을 수 있어
+		// 잠시 기다렸다가 스캔한다. exec 빈도는 낮아 직렬 처리로 충분하다.
+		time.Sleep(100 * time.Millisecond)
+		p.scanPID(pid)
+	}
 }
 
 func (p *ProcScanner) run() {
@@ -286,12 +347,17 @@ func (p *ProcScanner) scan() {
 		if e.Name() == selfPID {
 			continue
 		}
-		pid := e.Name()
-		p.scanMapsForSSL(pid)
-		p.scanExeForGoTLS(pid)
+		p.scanPID(e.Name())
 	}
 }
 
+// scanPID는 단일 프로세스에 대해 libssl / Go TLS attach 대상을 확인한다.
+// 주기 스캔과 exec 이벤트 경로가 공유하는 단위 작업이다.
+func (p *ProcScanner) scanPID(pid string) {
+	p.scanMapsForSSL(pid)
+	p.scanExeForGoTLS(pid)
+}
+
 // scanMapsForSSL reads /proc/<pid>/maps and attaches to any libssl.so path
 // that has not yet been seen.
 func (p *ProcScanner) scanMapsForSSL(pid string) {
@@ -330,7 +396,9 @@ func (p *ProcScanner) scanMapsForSSL(pid string) {
 }
 
 // scanExeForGoTLS reads /proc/<pid>/exe, attempts ELF symbol lookup for
-// crypto/tls symbols, and attaches uprobes if found.
+// crypto/tls (and, when EnableHTTP2 was called, hpack WriteField) symbols,
+// and attaches uprobes if found. 두 심볼군은 같은 ELF를 파싱하므로 한 번의
+// 스캔/캐시 엔트리로 함께 처리한다.
 func (p *ProcScanner) scanExeForGoTLS(pid string) {
 	exePath, err := os.Readlink("/proc/" + pid + "/exe")
 	if err != nil {
@@ -345,14 +413,52 @@ func (p *ProcScanner) scanExeForGoTLS(pid string) {
 	// Mark as seen immediately so failed binaries are not retried on every scan.
 	p.loader.markGoTLSSeen(exePath)
 
-	writeOff, readOff, readRetOffs, err := findGoTLSOffsets(exePath)
+	fi, err := os.Stat(exePath)
 	if err != nil {
-		// Not a Go binary, stripped, or doesn't use crypto/tls — skip silently.
 		return
 	}
 
-	if err := p.loader.AttachGoTLS(exePath, writeOff, readOff, readRetOffs); err != nil {
-		log.Printf("[SSL] AttachGoTLS %s: %v", exePath, err)
+	// On-disk 캐시 적중: ELF 파싱 없이 바로 attach (warm 노드 재시작 경로).
+	if ent, ok := p.cache.get(exePath, fi); ok {
+		if !ent.NotGoTLS {
+			if err := p.loader.AttachGoTLS(exePath, ent.WriteOff, ent.ReadOff, ent.ReadRetOffs); err != nil {
+				log.Printf("[SSL] AttachGoTLS %s (cached): %v", exePath, err)
+			}
+		}
+		if p.http2 != nil && len(ent.HTTP2Offs) > 0 {
+			if err := p.http2.AttachGoHTTP2(exePath, ent.HTTP2Offs); err != nil {
+				log.Printf("[HTTP2] AttachGoHTTP2 %s (cached): %v", exePath, err)
+			}
+		}
+		return
+	}
+
+	ent := cachedOffsets{}
+	writeOff, readOff, readRetOffs, tlsErr := findGoTLSOffsets(exePath)
+	if tlsErr != nil {
+		// Not a Go binary, fully stripped, or doesn't use crypto/tls.
+		// negative cache로 남겨 다음 재시작에서도 재파싱하지 않는다.
+		ent.NotGoTLS = true
+	} else {
+		ent.WriteOff = writeOff
+		ent.ReadOff = readOff
+		ent.ReadRetOffs = readRetOffs
+	}
+	if p.http2 != nil {
+		// 실패(비-HTTP/2 바이너리)는 빈 HTTP2Offs로 남는다 — 그 자체가 negative cache.
+		ent.HTTP2Offs, _ = findHPackWriteFieldOffsets(exePath)
+	}
+	p.cache.put(exePath, fi, ent)
+
+	if tlsErr == nil {
+		if err := p.loader.AttachGoTLS(exePath, writeOff, readOff, readRetOffs); err != nil {
+			log.Printf("[SSL] AttachGoTLS %s: %v", exePath, err)
+		}
+	}
+	if p.http2 != nil && len(ent.HTTP2Offs) > 0 {
+		if err := p.http2.AttachGoHTTP2(exePath, ent.HTTP2Offs); err != nil {
+			log.Printf("[HTTP2] AttachGoHTTP2 %s: %v", exePath, err)
+		}
 	}
 }
 
@@ -383,12 +489,8 @@ func findGoTLSOffsets(path string) (writeOff, readOff uint64, readRetOffs []uint
 	}
 	defer f.Close()
 
-	syms, err := f.Symbols()
-	if err != nil {
-		return 0, 0, nil, fmt.Errorf("no symbol table in %s: %w", path, err)
-	}
-
 	var writeVA, readVA, readSize uint64
+	syms, symErr := f.Symbols() // stripped 바이너리면 에러 — pclntab으로 폴백
 	for _, sym := range syms {
 		switch sym.Name {
 		case "crypto/tls.(*Conn).Write":
@@ -403,7 +505,11 @@ func findGoTLSOffsets(path string) (writeOff, readOff uint64, readRetOffs []uint
 	}
 
 	if writeVA == 0 || readVA == 0 {
-		return 0, 0, nil, fmt.Errorf("crypto/tls symbols not found in %s", path)
+		writeVA, readVA, readSize, err = goTLSOffsetsFromPclntab(f)
+		if err != nil {
+			return 0, 0, nil, fmt.Errorf("crypto/tls symbols not found in %s (symtab: %v; pclntab: %v)",
+				path, symErr, err)
+		}
 	}
 
 	writeOff, err = vaToFileOffset(f, writeVA)
@@ -423,6 +529,37 @@ func findGoTLSOffsets(path string) (writeOff, readOff uint64, readRetOffs []uint
 	return writeOff, readOff, readRetOffs, nil
 }
 
+// goTLSOffsetsFromPclntab는 심볼 테이블이 strip된 Go 바이너리에서
+// pclntab(.gopclntab)으로 crypto/tls 함수의 가상 주소와 크기를 복원한다.
+// pclntab은 Go 런타임이 스택 트레이스/GC에 쓰는 테이블이라 strip으로
+// 제거되지 않는다. (별도 섹션이 없는 PIE 빌드는 여기서도 실패한다.)
+func goTLSOffsetsFromPclntab(f *elf.File) (writeVA, readVA, readSize uint64, err error) {
+	pclnSec := f.Section(".gopclntab")
+	if pclnSec == nil {
+		return 0, 0, 0, fmt.Errorf("no .gopclntab section")
+	}
+	textSec := f.Section(".text")
+	if textSec == nil {
+		return 0, 0, 0, fmt.Errorf("no .text section")
+	}
+	data, err := pclnSec.Data()
+	if err != nil {
+		return 0, 0, 0, fmt.Errorf("reading .gopclntab: %w", err)
+	}
+
+	tab, err := gosym.NewTable(nil, gosym.NewLineTable(data, textSec.Addr))
+	if err != nil {
+		return 0, 0, 0, fmt.Errorf("parsing pclntab: %w", err)
+	}
+
+	w := tab.LookupFunc("crypto/tls.(*Conn).Write")
+	r := tab.LookupFunc("crypto/tls.(*Conn).Read")
+	if w == nil || r == nil {
+		return 0, 0, 0, fmt.Errorf("crypto/tls functions not in pclntab")
+	}
+	return w.Entry, r.Entry, r.End - r.Entry, nil
+}
+
 // findRetOffsets reads the function body at startOff (file offset) of the
 // given size and returns the file offsets of every RET instruction.
 // Supports arm64 (fixed 4-byte encoding) and amd64 (0xC3).
@@ -13,7 +13,7 @@ import (
 type SSLLoader struct{}
 
 // NewSSLLoader always returns an error on non-Linux platforms.
-func NewSSLLoader(_ *ciliumebpf.Map) (*SSLLoader, error) {
+func NewSSLLoader(_ map[string]*ciliumebpf.Map) (*SSLLoader, error) {
 	return nil, fmt.Errorf("SSL tracing requires Linux")
 }
 
@@ -28,6 +28,12 @@ func NewProcScanner(_ *SSLLoader, _ time.Duration) *ProcScanner {
 	return &ProcScanner{}
 }
 
+// EnableHTTP2 is a no-op.
+func (p *ProcScanner) EnableHTTP2(_ *HTTP2Loader) {}
+
+// WatchExec is a no-op.
+func (p *ProcScanner) WatchExec(_ *ciliumebpf.Map) error { return nil }
+
 // Start is a no-op.
 func (p *ProcScanner) Start() {}
 
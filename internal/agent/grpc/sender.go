@@ -4,55 +4,149 @@
 //   agent의 이벤트 루프에서 DataEvent를 받아 TraceEvent proto로 변환한 뒤,
 //   nefi-server의 NefiCollector.SendEvents 스트림에 전송한다.
 //
+// 배치 전송:
+//   이벤트를 TraceEventBatch로 묶어 maxBatchSize 또는 flushInterval 단위로
+//   flush한다. 이벤트당 marshal/HTTP2 frame 비용을 줄이고, gzip 압축으로
+//   payload 대역폭을 낮춘다.
+//
 // 재연결 전략:
 //   연결이 끊기면 exponential backoff(최대 30초)로 재연결을 시도한다.
 //   server가 잠시 내려가도 agent는 계속 캡처를 유지한다.
+//
+// 수평 샤딩:
+//   serverAddr에 주소를 쉼표로 여러 개 주면 backend마다 독립 스트림을
+//   유지하고, 이벤트를 {PodName, Pid, Fd} 해시로 일관되게 라우팅한다.
+//   같은 연결의 요청/응답이 항상 같은 replica에 도착하므로 server의
+//   connTracker 페어링이 replica 수와 무관하게 동작한다.
 package grpc
 
 import (
 	"context"
 	"log"
+	"math"
+	"strings"
+	"sync/atomic"
 	"time"
 
 	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
 	"github.com/gihongjo/nefi/internal/model"
+	"golang.org/x/sys/unix"
 	"google.golang.org/grpc"
 	"google.golang.org/grpc/credentials/insecure"
+	"google.golang.org/grpc/encoding/gzip"
 )
 
 const (
 	initialBackoff = 1 * time.Second
 	maxBackoff     = 30 * time.Second
-	sendChanSize   = 512
+	sendChanSize   = 4096 // 배치 flush 사이 burst를 흡수할 수 있도록 여유있게
+
+	maxBatchSize  = 256                    // 배치당 최대 이벤트 수
+	flushInterval = 200 * time.Millisecond // 배치가 차지 않아도 이 주기로 flush
 )
 
+// backend는 collector replica 하나와 그쪽으로 가는 전송 큐다.
+type backend struct {
+	addr string
+	ch   chan *nefiv1.TraceEvent
+}
+
 // Sender는 nefi-server로 이벤트를 스트리밍하는 gRPC 클라이언트다.
+// backend가 여러 개면 connection-affinity 해시로 샤딩한다.
 type Sender struct {
-	serverAddr string
-	nodeName   string
-	ch         chan *nefiv1.TraceEvent
-	done       chan struct{}
+	backends []*backend
+	nodeName string
+	done     chan struct{}
+
+	// 부팅 시점의 wall clock(UnixNano). 커널 이벤트의 timestamp_ns는
+	// bpf_ktime_get_ns() = CLOCK_MONOTONIC(부팅 이후 ns)이므로, 이 오프셋을
+	// 더해 wall clock으로 내보낸다. collector의 디스크 retention과
+	// since_ns/until_ns 범위 조회가 모두 UnixNano 기준이다.
+	bootEpochNs uint64
+
+	// hot-path 카운터 — /metrics에서 읽는다. 큐 가득 참 drop은 지금까지
+	// bare default로 조용히 사라지던 지점이라 반드시 셀 수 있어야 한다.
+	enqueued atomic.Uint64 // 큐에 들어간 이벤트 수
+	drops    atomic.Uint64 // 큐 가득 참으로 drop된 이벤트 수
 }
 
-// New는 Sender를 생성하고 백그라운드 전송 고루틴을 시작한다.
-// serverAddr: nefi-server gRPC 주소 (예: "nefi-server:9090")
+// New는 Sender를 생성하고 backend별 전송 고루틴을 시작한다.
+// serverAddr: nefi-server gRPC 주소, 쉼표로 여러 개 가능
+// (예: "nefi-server-0:9090,nefi-server-1:9090")
 // nodeName: 이 agent가 실행 중인 노드 이름
 func New(serverAddr, nodeName string) *Sender {
 	s := &Sender{
-		serverAddr: serverAddr,
-		nodeName:   nodeName,
-		ch:         make(chan *nefiv1.TraceEvent, sendChanSize),
-		done:       make(chan struct{}),
+		nodeName:    nodeName,
+		done:        make(chan struct{}),
+		bootEpochNs: bootEpochNs(),
+	}
+	for _, addr := range strings.Split(serverAddr, ",") {
+		addr = strings.TrimSpace(addr)
+		if addr == "" {
+			continue
+		}
+		b := &backend{addr: addr, ch: make(chan *nefiv1.TraceEvent, sendChanSize)}
+		s.backends = append(s.backends, b)
+		go s.run(b)
 	}
-	go s.run()
 	return s
 }
 
+// bootEpochNs는 부팅 시점의 wall clock(UnixNano)을 구한다. 같은
+// CLOCK_MONOTONIC을 읽어 현재 wall clock에서 빼면 되고, 두 클록 읽기
+// 사이의 틈은 µs 수준이라 무시할 수 있다. 실패하면 0을 반환해 timestamp가
+// boot-relative로 남는다 (linux에서 실제로 실패하는 경우는 없다).
+func bootEpochNs() uint64 {
+	var ts unix.Timespec
+	if err := unix.ClockGettime(unix.CLOCK_MONOTONIC, &ts); err != nil {
+		log.Printf("clock_gettime(CLOCK_MONOTONIC): %v — timestamps stay boot-relative", err)
+		return 0
+	}
+	return uint64(time.Now().UnixNano() - ts.Nano())
+}
+
+// enqueue는 이벤트를 affinity 해시로 고른 backend 큐에 넣는다.
+// 해시는 collector connKey와 같은 {PodName, PID, FD} FNV-1a — replica가
+// 늘어도 같은 연결은 같은 replica로 간다 (목록 순서가 바뀌지 않는 한).
+func (s *Sender) enqueue(proto *nefiv1.TraceEvent) {
+	b := s.backends[affinityHash(proto)%uint32(len(s.backends))]
+	select {
+	case b.ch <- proto:
+		s.enqueued.Add(1)
+	default:
+		s.drops.Add(1) // 큐 가득 참 → drop
+	}
+}
+
+func affinityHash(ev *nefiv1.TraceEvent) uint32 {
+	const (
+		offset32 = 2166136261
+		prime32  = 16777619
+	)
+	h := uint32(offset32)
+	for i := 0; i < len(ev.PodName); i++ {
+		h ^= uint32(ev.PodName[i])
+		h *= prime32
+	}
+	for _, v := range [...]uint32{ev.Pid, ev.Fd} {
+		h ^= v & 0xff
+		h *= prime32
+		h ^= (v >> 8) & 0xff
+		h *= prime32
+		h ^= (v >> 16) & 0xff
+		h *= prime32
+		h ^= v >> 24
+		h *= prime32
+	}
+	return h
+}
+
 // Send는 DataEvent를 TraceEvent로 변환해 전송 큐에 넣는다.
 // 큐가 가득 차면 이벤트를 drop한다 (캡처 루프 블로킹 방지).
 func (s *Sender) Send(ev *model.DataEvent, namespace, podName, remoteNs, remotePod string) {
 	proto := &nefiv1.TraceEvent{
-		TimestampNs: ev.TimestampNs,
+		// boot-relative(bpf_ktime_get_ns) → wall clock(UnixNano)
+		TimestampNs: s.bootEpochNs + ev.TimestampNs,
 		Pid:         ev.PID,
 		Fd:          ev.FD,
 		MsgSize:     ev.MsgSize,
@@ -67,14 +161,49 @@ func (s *Sender) Send(ev *model.DataEvent, namespace, podName, remoteNs, remoteP
 		RemotePort:  uint32(ev.RemotePort),
 		RemoteNs:    remoteNs,
 		RemotePod:   remotePod,
-		Payload:     ev.Payload(),
+		// 커널이 페어링한 latency (MSG_RESPONSE에서만 0이 아님)
+		LatencyNs: ev.LatencyNs,
+		// ReadBatch가 Msg 버퍼를 재사용하므로 큐에 넣기 전에 복사한다.
+		Payload: append([]byte(nil), ev.Payload()...),
 	}
+	s.enqueue(proto)
+}
 
-	select {
-	case s.ch <- proto:
-	default:
-		// 큐 가득 참 → drop
+// SendStat는 pre-aggregation 모드의 커널 집계 결과를 synthetic TraceEvent로
+// 큐에 넣는다. sample_count > 0이 synthetic 이벤트의 표식이며, latency_ns에는
+// latency_count개 샘플의 누적 합이 실린다 (server aggregator가 평균을 산출).
+func (s *Sender) SendStat(st *model.AggStat, namespace, podName, remoteNs, remotePod string) {
+	bytes := st.Bytes
+	if bytes > math.MaxUint32 {
+		bytes = math.MaxUint32
+	}
+	proto := &nefiv1.TraceEvent{
+		TimestampNs:  uint64(time.Now().UnixNano()),
+		Pid:          st.PID,
+		MsgSize:      uint32(bytes),
+		Protocol:     uint32(st.Protocol),
+		MsgType:      uint32(st.MsgType),
+		Namespace:    namespace,
+		PodName:      podName,
+		NodeName:     s.nodeName,
+		RemoteIp:     st.RemoteIP,
+		RemoteNs:     remoteNs,
+		RemotePod:    remotePod,
+		LatencyNs:    st.LatencySumNs,
+		SampleCount:  st.Count,
+		LatencyCount: st.LatencyCount,
 	}
+	s.enqueue(proto)
+}
+
+// Stats는 전송 큐(backend 전체 합산)의 현재 깊이/용량과 누적
+// enqueue/drop 수를 반환한다.
+func (s *Sender) Stats() (depth, capacity int, enqueued, drops uint64) {
+	for _, b := range s.backends {
+		depth += len(b.ch)
+		capacity += cap(b.ch)
+	}
+	return depth, capacity, s.enqueued.Load(), s.drops.Load()
 }
 
 // Close는 Sender를 종료하고 gRPC 연결을 닫는다.
@@ -82,9 +211,9 @@ func (s *Sender) Close() {
 	close(s.done)
 }
 
-// run은 server에 연결하고 이벤트를 스트리밍한다.
+// run은 backend 하나에 연결하고 그쪽 큐의 이벤트를 스트리밍한다.
 // 연결이 끊기면 exponential backoff로 재연결한다.
-func (s *Sender) run() {
+func (s *Sender) run(b *backend) {
 	backoff := initialBackoff
 	for {
 		select {
@@ -93,7 +222,7 @@ func (s *Sender) run() {
 		default:
 		}
 
-		connected, err := s.stream()
+		connected, err := s.stream(b)
 		if connected {
 			// 연결에 성공했다가 끊어진 경우 backoff 초기화
 			backoff = initialBackoff
@@ -115,11 +244,11 @@ func (s *Sender) run() {
 	}
 }
 
-// stream은 서버에 연결하고 이벤트를 스트리밍한다.
+// stream은 backend 서버에 연결하고 이벤트를 스트리밍한다.
 // connected=true는 한 번이라도 스트림 전송에 성공했음을 의미하며,
 // 호출자가 backoff를 리셋하는 데 사용된다.
-func (s *Sender) stream() (connected bool, err error) {
-	conn, dialErr := grpc.NewClient(s.serverAddr,
+func (s *Sender) stream(b *backend) (connected bool, err error) {
+	conn, dialErr := grpc.NewClient(b.addr,
 		grpc.WithTransportCredentials(insecure.NewCredentials()),
 	)
 	if dialErr != nil {
@@ -131,25 +260,52 @@ func (s *Sender) stream() (connected bool, err error) {
 	ctx, cancel := context.WithCancel(context.Background())
 	defer cancel()
 
-	st, streamErr := client.SendEvents(ctx)
+	st, streamErr := client.SendEvents(ctx, grpc.UseCompressor(gzip.Name))
 	if streamErr != nil {
 		return false, streamErr
 	}
 
-	log.Printf("[sender] connected to server %s", s.serverAddr)
+	log.Printf("[sender] connected to server %s", b.addr)
 	connected = true
 
+	// 이벤트를 배치로 모아 전송한다. maxBatchSize에 도달하거나
+	// flushInterval이 지나면 flush한다.
+	batch := &nefiv1.TraceEventBatch{
+		Events: make([]*nefiv1.TraceEvent, 0, maxBatchSize),
+	}
+	// Send는 리턴 전에 marshal을 끝내므로 slice 재사용이 안전하다.
+	flush := func() error {
+		if len(batch.Events) == 0 {
+			return nil
+		}
+		err := st.Send(batch)
+		batch.Events = batch.Events[:0]
+		return err
+	}
+
+	ticker := time.NewTicker(flushInterval)
+	defer ticker.Stop()
+
 	for {
 		select {
 		case <-s.done:
+			flush() //nolint:errcheck — 종료 중이므로 남은 배치는 best effort
 			_, err := st.CloseAndRecv()
 			return connected, err
-		case ev, ok := <-s.ch:
+		case <-ticker.C:
+			if err := flush(); err != nil {
+				return connected, err
+			}
+		case ev, ok := <-b.ch:
 			if !ok {
+				flush() //nolint:errcheck
 				return connected, nil
 			}
-			if err := st.Send(ev); err != nil {
-				return connected, err
+			batch.Events = append(batch.Events, ev)
+			if len(batch.Events) >= maxBatchSize {
+				if err := flush(); err != nil {
+					return connected, err
+				}
 			}
 		}
 	}
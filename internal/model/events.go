@@ -7,20 +7,26 @@
 //   그대로 읽어낸다.
 //
 // 중요 제약:
-//   DataEvent 구조체의 필드 순서와 크기는 C의 data_event_t와 정확히 일치해야 한다.
+//   DecodeDataEvent의 필드 오프셋은 C의 data_event_t와 정확히 일치해야 한다.
 //   한 바이트라도 어긋나면 모든 필드가 잘못된 값으로 읽힌다.
 //
 // 흐름:
-//   커널 BPF → ringbuf에 data_event_t(4143 bytes) 저장
-//   → loader.go가 binary.LittleEndian으로 읽음
+//   커널 BPF → ringbuf에 가변 길이 레코드(55바이트 헤더 + bucket 페이로드) 저장
+//   → loader.go가 DecodeDataEvent로 파싱
 //   → DataEvent 구조체로 변환
 //   → main.go에서 출력
 package model
 
-import "fmt"
+import (
+	"encoding/binary"
+	"fmt"
+)
 
 const MaxMsgSize = 4096
 
+// EventHeaderSize는 data_event_t 고정 헤더의 크기다 (msg 제외).
+const EventHeaderSize = 55
+
 // Protocol matches the BPF enum protocol_t (Pixie-compatible numbering).
 type Protocol uint8
 
@@ -76,12 +82,11 @@ func (m MsgType) String() string {
 }
 
 // DataEvent matches the packed BPF struct data_event_t.
-// Field order and sizes must exactly match the C definition.
 //
-// C layout (packed, 4143 bytes total):
+// C layout (packed, variable length — 55-byte header + bucketed payload):
 //   u64 timestamp_ns  u32 pid  u32 fd  u32 msg_size
 //   u8 direction  u8 protocol  u8 msg_type  char comm[16]
-//   u32 remote_ip  u16 remote_port  u16 _pad  char msg[4096]
+//   u32 remote_ip  u16 remote_port  u64 latency_ns  u16 cap_len  char msg[]
 type DataEvent struct {
 	TimestampNs uint64
 	PID         uint32
@@ -91,10 +96,61 @@ type DataEvent struct {
 	Protocol    Protocol
 	MsgType     MsgType
 	Comm        [16]byte
-	RemoteIP    uint32  // host byte order; 0 if unknown
-	RemotePort  uint16  // host byte order; 0 if unknown
-	Pad_        [2]byte // padding; exported because encoding/binary cannot set unexported fields
-	Msg         [MaxMsgSize]byte
+	RemoteIP    uint32 // host byte order; 0 if unknown
+	RemotePort  uint16 // host byte order; 0 if unknown
+	LatencyNs   uint64 // 커널이 페어링한 request→response latency; 0 = unknown
+	CapLen      uint16 // payload bytes present in the record (≤ MsgSize)
+	Msg         []byte // captured payload (CapLen bytes)
+}
+
+// DecodeDataEvent는 ringbuf raw 레코드를 새 DataEvent로 파싱한다.
+func DecodeDataEvent(raw []byte) (*DataEvent, error) {
+	e := &DataEvent{}
+	if err := DecodeDataEventInto(e, raw); err != nil {
+		return nil, err
+	}
+	return e, nil
+}
+
+// DecodeDataEventInto는 raw 레코드를 호출자가 제공한 DataEvent에 파싱한다.
+// e.Msg의 기존 capacity를 재사용하므로 핫 루프에서 이벤트당 할당이 없다.
+// 오프셋은 C data_event_t의 packed 레이아웃을 그대로 따른다.
+func DecodeDataEventInto(e *DataEvent, raw []byte) error {
+	if len(raw) < EventHeaderSize {
+		return fmt.Errorf("event record too short: %d bytes", len(raw))
+	}
+	e.TimestampNs = binary.LittleEndian.Uint64(raw[0:8])
+	e.PID = binary.LittleEndian.Uint32(raw[8:12])
+	e.FD = binary.LittleEndian.Uint32(raw[12:16])
+	e.MsgSize = binary.LittleEndian.Uint32(raw[16:20])
+	e.Direction = raw[20]
+	e.Protocol = Protocol(raw[21])
+	e.MsgType = MsgType(raw[22])
+	copy(e.Comm[:], raw[23:39])
+	e.RemoteIP = binary.LittleEndian.Uint32(raw[39:43])
+	e.RemotePort = binary.LittleEndian.Uint16(raw[43:45])
+	e.LatencyNs = binary.LittleEndian.Uint64(raw[45:53])
+	e.CapLen = binary.LittleEndian.Uint16(raw[53:55])
+
+	n := int(e.CapLen)
+	if n > len(raw)-EventHeaderSize {
+		n = len(raw) - EventHeaderSize
+	}
+	e.Msg = append(e.Msg[:0], raw[EventHeaderSize:EventHeaderSize+n]...)
+	return nil
+}
+
+// AggStat는 pre-aggregation 모드에서 커널이 per-flow로 집계한 카운터다.
+// BPF의 agg_key_t/agg_stat_t를 per-CPU 합산한 결과에 해당한다.
+type AggStat struct {
+	PID          uint32
+	RemoteIP     uint32 // host byte order; 0 if unknown
+	Protocol     Protocol
+	MsgType      MsgType
+	Count        uint64 // 집계된 이벤트 수
+	Bytes        uint64 // msg_size 누적 합
+	LatencySumNs uint64 // 페어링된 request→response latency 누적 합
+	LatencyCount uint64 // LatencySumNs에 포함된 샘플 수
 }
 
 // CommString returns the process name with null bytes trimmed.
@@ -107,13 +163,9 @@ func (e *DataEvent) CommString() string {
 	return string(e.Comm[:])
 }
 
-// Payload returns the captured message bytes (up to MsgSize).
+// Payload returns the captured message bytes (CapLen bytes, ≤ MsgSize).
 func (e *DataEvent) Payload() []byte {
-	n := e.MsgSize
-	if n > MaxMsgSize {
-		n = MaxMsgSize
-	}
-	return e.Msg[:n]
+	return e.Msg
 }
 
 // DirectionString returns "SEND" or "RECV".
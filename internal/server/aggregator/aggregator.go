@@ -5,10 +5,22 @@
 //   - 현재 초의 bucket에 엔드포인트별 카운터(total/success/error)를 기록한다.
 //   - 매 1초마다 window 범위의 bucket을 합산해 구독자에게 전파한다.
 //
+// 동시성:
+//   bucket 맵은 EndpointKey 해시로 numShards개 shard에 분산되고 shard마다
+//   독립된 mutex를 갖는다. record()는 자기 shard 하나만 잠그므로 서로 다른
+//   엔드포인트의 이벤트는 코어 간 경합 없이 병렬로 기록된다. Snapshot()도
+//   shard를 하나씩 잠그고 merge하므로 전역 stop-the-world가 없다.
+//
+// 레이턴시:
+//   Counts는 합/평균에 더해 log2 고정-bucket 히스토그램을 갖는다.
+//   element-wise 덧셈으로 merge되는 구조라 bucket 간/shard 간 합산이
+//   자유롭고, 윈도우 집계에서 p50/p95/p99를 산출한다 (상한 오차 2배 이내).
+//
 // 메모리: 최대 300 bucket (5분) × 엔드포인트 수. 트래픽 양과 무관하게 고정 크기.
 package aggregator
 
 import (
+	"math/bits"
 	"regexp"
 	"sync"
 	"time"
@@ -41,6 +53,14 @@ const (
 	maxWindowSec     = 300 // 최대 윈도우: 5분
 	DefaultWindowSec = 60  // Subscribe() 기본 윈도우: 60초
 	subChanSize      = 4
+
+	// numShards는 bucket 맵 shard 수다. 2의 거듭제곱이어야 한다.
+	// 서버 코어 수보다 넉넉하게 잡아 해시 충돌로 인한 경합을 낮춘다.
+	numShards = 16
+
+	// latencyBuckets는 log2 히스토그램 bucket 수다.
+	// bucket i는 [2^(i-1), 2^i) ns를 담는다 — 2^39 ns ≈ 9분까지 커버.
+	latencyBuckets = 40
 )
 
 // EndpointKey는 집계 단위 키다.
@@ -51,13 +71,86 @@ type EndpointKey struct {
 	Path      string
 }
 
+// shardIndex는 EndpointKey의 FNV-1a 해시로 shard를 고른다.
+func (k *EndpointKey) shardIndex() uint32 {
+	const (
+		offset32 = 2166136261
+		prime32  = 16777619
+	)
+	h := uint32(offset32)
+	for _, s := range [...]string{k.Namespace, k.PodName, k.Method, k.Path} {
+		for i := 0; i < len(s); i++ {
+			h ^= uint32(s[i])
+			h *= prime32
+		}
+		h ^= 0xff // 필드 경계 구분자 (["a","bc"]와 ["ab","c"]가 같은 해시가 되지 않게)
+		h *= prime32
+	}
+	return h & (numShards - 1)
+}
+
+// latencyBucket은 latency(ns)가 속하는 log2 bucket 인덱스를 반환한다.
+func latencyBucket(ns uint64) int {
+	b := bits.Len64(ns) // 2^(b-1) <= ns < 2^b
+	if b >= latencyBuckets {
+		b = latencyBuckets - 1
+	}
+	return b
+}
+
+// bucketUpperMs는 log2 bucket의 상한을 ms로 반환한다.
+func bucketUpperMs(idx int) float64 {
+	return float64(uint64(1)<<uint(idx)) / 1e6
+}
+
 // Counts는 한 bucket 내 한 엔드포인트의 요청 카운터다.
+// 모든 필드가 덧셈으로 merge되는 구조라 bucket/shard 합산이 자유롭다.
 type Counts struct {
-	Total       int32
-	Success     int32 // 2xx
-	Error       int32 // 4xx, 5xx
-	LatencySum  int64 // 누적 latency (ns), latency가 있는 이벤트만 합산
+	Total        int32
+	Success      int32 // 2xx
+	Error        int32 // 4xx, 5xx
+	LatencySum   int64 // 누적 latency (ns), latency가 있는 이벤트만 합산
 	LatencyCount int32 // latency가 측정된 이벤트 수
+	// LatencyHist는 log2 고정-bucket 히스토그램이다. percentile은 bucket
+	// 상한으로 보고하므로 최대 2배 과대평가될 수 있다 — tail을 숨기는
+	// 평균보다 훨씬 낫고, merge가 element-wise 덧셈이라 sketch보다 단순하다.
+	LatencyHist [latencyBuckets]int32
+}
+
+// Merge는 o를 c에 element-wise로 더한다. bucket/shard 간뿐 아니라
+// replica 간(sharded 배포의 /api/v1/stats/raw merge)에도 쓰인다.
+func (c *Counts) Merge(o *Counts) {
+	c.Total += o.Total
+	c.Success += o.Success
+	c.Error += o.Error
+	c.LatencySum += o.LatencySum
+	c.LatencyCount += o.LatencyCount
+	for i := range c.LatencyHist {
+		c.LatencyHist[i] += o.LatencyHist[i]
+	}
+}
+
+// percentileMs는 히스토그램에서 q(0~1) 분위 latency를 ms로 추정한다.
+func (c *Counts) percentileMs(q float64) float64 {
+	total := int32(0)
+	for _, n := range c.LatencyHist {
+		total += n
+	}
+	if total == 0 {
+		return 0
+	}
+	target := int32(q*float64(total) + 0.5)
+	if target < 1 {
+		target = 1
+	}
+	cum := int32(0)
+	for i, n := range c.LatencyHist {
+		cum += n
+		if cum >= target {
+			return bucketUpperMs(i)
+		}
+	}
+	return bucketUpperMs(latencyBuckets - 1)
 }
 
 // EndpointStat는 윈도우 집계 결과 하나다.
@@ -70,8 +163,11 @@ type EndpointStat struct {
 	Total        int32   `json:"total"`
 	Success      int32   `json:"success"`
 	Error        int32   `json:"error"`
-	SuccessRate  float64 `json:"success_rate"`  // 0.0~100.0
+	SuccessRate  float64 `json:"success_rate"`   // 0.0~100.0
 	AvgLatencyMs float64 `json:"avg_latency_ms"` // 평균 레이턴시 (ms), 측정값 없으면 0
+	P50LatencyMs float64 `json:"p50_latency_ms"` // 히스토그램 기반 (pre-agg 이벤트 제외)
+	P95LatencyMs float64 `json:"p95_latency_ms"`
+	P99LatencyMs float64 `json:"p99_latency_ms"`
 }
 
 type bucket struct {
@@ -79,14 +175,39 @@ type bucket struct {
 	stats map[EndpointKey]Counts
 }
 
-// Aggregator는 슬라이딩 윈도우 bucket 집계기다.
-type Aggregator struct {
+// shard는 bucket 슬라이스 하나와 그것을 보호하는 mutex다.
+type shard struct {
 	mu      sync.Mutex
 	buckets []bucket
-	subs    map[chan []EndpointStat]struct{}
-	store   store.Store
+}
+
+// record는 shard의 현재 초 bucket에 apply를 적용한다.
+func (s *shard) record(key EndpointKey, apply func(c *Counts)) {
+	sec := time.Now().Unix()
+
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	if len(s.buckets) == 0 || s.buckets[len(s.buckets)-1].sec != sec {
+		s.buckets = append(s.buckets, bucket{
+			sec:   sec,
+			stats: make(map[EndpointKey]Counts),
+		})
+	}
+	b := &s.buckets[len(s.buckets)-1]
+	c := b.stats[key]
+	apply(&c)
+	b.stats[key] = c
+}
+
+// Aggregator는 슬라이딩 윈도우 bucket 집계기다.
+type Aggregator struct {
+	shards   [numShards]shard
+	subMu    sync.Mutex
+	subs     map[chan []EndpointStat]struct{}
+	store    store.Store
 	storeSub <-chan *nefiv1.TraceEvent
-	done    chan struct{}
+	done     chan struct{}
 }
 
 // New는 store를 구독하고 백그라운드 집계를 시작하는 Aggregator를 반환한다.
@@ -102,8 +223,9 @@ func New(s store.Store) *Aggregator {
 	return a
 }
 
-// Snapshot은 주어진 windowSec(1~300) 범위의 집계 결과를 반환한다.
-func (a *Aggregator) Snapshot(windowSec int) []EndpointStat {
+// merged는 windowSec(1~300) 범위의 bucket을 EndpointKey별로 합산한다.
+// shard를 하나씩 잠그고 merge하므로 record()를 전역적으로 멈추지 않는다.
+func (a *Aggregator) merged(windowSec int) map[EndpointKey]Counts {
 	if windowSec < 1 {
 		windowSec = 1
 	}
@@ -112,46 +234,79 @@ func (a *Aggregator) Snapshot(windowSec int) []EndpointStat {
 	}
 	cutoff := time.Now().Unix() - int64(windowSec)
 
-	a.mu.Lock()
 	merged := make(map[EndpointKey]Counts)
-	for _, b := range a.buckets {
-		if b.sec <= cutoff {
-			continue
-		}
-		for k, c := range b.stats {
-			m := merged[k]
-			m.Total += c.Total
-			m.Success += c.Success
-			m.Error += c.Error
-			m.LatencySum += c.LatencySum
-			m.LatencyCount += c.LatencyCount
-			merged[k] = m
+	for i := range a.shards {
+		s := &a.shards[i]
+		s.mu.Lock()
+		for _, b := range s.buckets {
+			if b.sec <= cutoff {
+				continue
+			}
+			for k, c := range b.stats {
+				m := merged[k]
+				m.Merge(&c)
+				merged[k] = m
+			}
 		}
+		s.mu.Unlock()
 	}
-	a.mu.Unlock()
+	return merged
+}
 
-	result := make([]EndpointStat, 0, len(merged))
-	for k, c := range merged {
-		rate := 0.0
-		if c.Total > 0 {
-			rate = float64(c.Success) / float64(c.Total) * 100
-		}
-		avgLatencyMs := 0.0
-		if c.LatencyCount > 0 {
-			avgLatencyMs = float64(c.LatencySum) / float64(c.LatencyCount) / 1e6
-		}
-		result = append(result, EndpointStat{
-			Namespace:    k.Namespace,
-			WorkloadName: WorkloadName(k.PodName),
-			PodName:      k.PodName,
-			Method:       k.Method,
-			Path:         k.Path,
-			Total:        c.Total,
-			Success:      c.Success,
-			Error:        c.Error,
-			SuccessRate:  rate,
-			AvgLatencyMs: avgLatencyMs,
-		})
+// StatFor는 합산이 끝난 Counts를 API로 내보내는 EndpointStat로 변환한다.
+// 비율/percentile 같은 파생값은 merge가 불가능하므로 반드시 raw Counts를
+// 모두 합친 뒤 마지막에 한 번만 계산해야 한다 — sharded 배포의 replica 간
+// merge(api 패키지)가 이 함수를 같은 이유로 쓴다.
+func StatFor(k EndpointKey, c *Counts) EndpointStat {
+	rate := 0.0
+	if c.Total > 0 {
+		rate = float64(c.Success) / float64(c.Total) * 100
+	}
+	avgLatencyMs := 0.0
+	if c.LatencyCount > 0 {
+		avgLatencyMs = float64(c.LatencySum) / float64(c.LatencyCount) / 1e6
+	}
+	return EndpointStat{
+		Namespace:    k.Namespace,
+		WorkloadName: WorkloadName(k.PodName),
+		PodName:      k.PodName,
+		Method:       k.Method,
+		Path:         k.Path,
+		Total:        c.Total,
+		Success:      c.Success,
+		Error:        c.Error,
+		SuccessRate:  rate,
+		AvgLatencyMs: avgLatencyMs,
+		P50LatencyMs: c.percentileMs(0.50),
+		P95LatencyMs: c.percentileMs(0.95),
+		P99LatencyMs: c.percentileMs(0.99),
+	}
+}
+
+// Snapshot은 주어진 windowSec(1~300) 범위의 집계 결과를 반환한다.
+func (a *Aggregator) Snapshot(windowSec int) []EndpointStat {
+	m := a.merged(windowSec)
+	result := make([]EndpointStat, 0, len(m))
+	for k, c := range m {
+		result = append(result, StatFor(k, &c))
+	}
+	return result
+}
+
+// RawEndpointStat는 replica 간 merge 가능한 원시 집계 한 건이다.
+// Counts가 element-wise 덧셈으로 합쳐지므로 여러 replica의 raw 결과를
+// 더한 뒤 StatFor로 변환하면 단일 프로세스와 같은 결과가 나온다.
+type RawEndpointStat struct {
+	Key    EndpointKey `json:"key"`
+	Counts Counts      `json:"counts"`
+}
+
+// SnapshotRaw는 windowSec 범위의 원시 집계를 반환한다 (/api/v1/stats/raw).
+func (a *Aggregator) SnapshotRaw(windowSec int) []RawEndpointStat {
+	m := a.merged(windowSec)
+	result := make([]RawEndpointStat, 0, len(m))
+	for k, c := range m {
+		result = append(result, RawEndpointStat{Key: k, Counts: c})
 	}
 	return result
 }
@@ -159,15 +314,15 @@ func (a *Aggregator) Snapshot(windowSec int) []EndpointStat {
 // Subscribe는 매 1초마다 defaultWindowSec 범위의 집계 결과를 받는 채널을 반환한다.
 func (a *Aggregator) Subscribe() <-chan []EndpointStat {
 	ch := make(chan []EndpointStat, subChanSize)
-	a.mu.Lock()
+	a.subMu.Lock()
 	a.subs[ch] = struct{}{}
-	a.mu.Unlock()
+	a.subMu.Unlock()
 	return ch
 }
 
 // Unsubscribe는 구독 채널을 해제한다.
 func (a *Aggregator) Unsubscribe(ch <-chan []EndpointStat) {
-	a.mu.Lock()
+	a.subMu.Lock()
 	for k := range a.subs {
 		if k == ch {
 			delete(a.subs, k)
@@ -175,7 +330,7 @@ func (a *Aggregator) Unsubscribe(ch <-chan []EndpointStat) {
 			break
 		}
 	}
-	a.mu.Unlock()
+	a.subMu.Unlock()
 }
 
 // Close는 집계를 중단하고 store 구독을 해제한다.
@@ -199,11 +354,17 @@ func (a *Aggregator) consume() {
 	}
 }
 
-// record는 HTTP 응답 이벤트를 현재 초의 bucket에 기록한다.
+// record는 HTTP 응답 이벤트를 해당 shard의 현재 초 bucket에 기록한다.
 // status가 없는 이벤트(요청)는 집계에서 제외한다.
 // collector의 connTracker가 응답 이벤트에 요청의 method/path를 채워주므로
 // 응답만 집계해도 엔드포인트별 성공률을 올바르게 산출할 수 있다.
 func (a *Aggregator) record(ev *nefiv1.TraceEvent) {
+	// Pre-aggregation 모드의 synthetic stat 이벤트 (sample_count > 0):
+	// payload가 없어 HTTP 파싱이 불가능하므로 카운터를 직접 반영한다.
+	if ev.SampleCount > 0 {
+		a.recordAgg(ev)
+		return
+	}
 	if ev.HttpStatus == 0 {
 		return
 	}
@@ -213,31 +374,48 @@ func (a *Aggregator) record(ev *nefiv1.TraceEvent) {
 		Method:    ev.HttpMethod,
 		Path:      ev.HttpPath,
 	}
-	sec := time.Now().Unix()
+	status := ev.HttpStatus
+	latency := ev.LatencyNs
 
-	a.mu.Lock()
-	defer a.mu.Unlock()
+	a.shards[key.shardIndex()].record(key, func(c *Counts) {
+		c.Total++
+		if status >= 200 && status < 400 {
+			c.Success++
+		} else if status >= 400 {
+			c.Error++
+		}
+		if latency > 0 {
+			c.LatencySum += int64(latency)
+			c.LatencyCount++
+			c.LatencyHist[latencyBucket(latency)]++
+		}
+	})
+}
 
-	// 현재 초 bucket이 없으면 추가
-	if len(a.buckets) == 0 || a.buckets[len(a.buckets)-1].sec != sec {
-		a.buckets = append(a.buckets, bucket{
-			sec:   sec,
-			stats: make(map[EndpointKey]Counts),
-		})
-	}
-	b := &a.buckets[len(a.buckets)-1]
-	c := b.stats[key]
-	c.Total++
-	if ev.HttpStatus >= 200 && ev.HttpStatus < 400 {
-		c.Success++
-	} else if ev.HttpStatus >= 400 {
-		c.Error++
+// recordAgg는 커널 집계 synthetic stat 이벤트를 bucket에 반영한다.
+// 응답 이벤트(msg_type=2)만 카운트해 record()의 "응답만 집계" 규칙을 따른다.
+// status/endpoint 정보가 없는 것이 counters-only 모드의 트레이드오프다:
+// Total과 평균 latency는 정확하지만 Success/Error는 0으로 남고, 개별 샘플이
+// 없으므로 히스토그램(percentile)에도 반영되지 않는다.
+func (a *Aggregator) recordAgg(ev *nefiv1.TraceEvent) {
+	if ev.MsgType != 2 {
+		return
 	}
-	if ev.LatencyNs > 0 {
-		c.LatencySum += int64(ev.LatencyNs)
-		c.LatencyCount++
+	key := EndpointKey{
+		Namespace: ev.Namespace,
+		PodName:   ev.PodName,
 	}
-	b.stats[key] = c
+	sampleCount := int32(ev.SampleCount)
+	latencySum := int64(ev.LatencyNs) // synthetic 이벤트에서는 누적 합
+	latencyCount := int32(ev.LatencyCount)
+
+	a.shards[key.shardIndex()].record(key, func(c *Counts) {
+		c.Total += sampleCount
+		if latencyCount > 0 {
+			c.LatencySum += latencySum
+			c.LatencyCount += latencyCount
+		}
+	})
 }
 
 // tick은 매 1초마다 오래된 bucket을 제거하고 구독자에게 stats를 전파한다.
@@ -251,12 +429,12 @@ func (a *Aggregator) tick() {
 		case <-ticker.C:
 			a.prune()
 			stats := a.Snapshot(DefaultWindowSec)
-			a.mu.Lock()
+			a.subMu.Lock()
 			subs := make([]chan []EndpointStat, 0, len(a.subs))
 			for ch := range a.subs {
 				subs = append(subs, ch)
 			}
-			a.mu.Unlock()
+			a.subMu.Unlock()
 			for _, ch := range subs {
 				select {
 				case ch <- stats:
@@ -267,19 +445,22 @@ func (a *Aggregator) tick() {
 	}
 }
 
-// prune은 maxWindowSec보다 오래된 bucket을 제거한다.
+// prune은 maxWindowSec보다 오래된 bucket을 shard별로 제거한다.
 func (a *Aggregator) prune() {
 	cutoff := time.Now().Unix() - maxWindowSec
-	a.mu.Lock()
-	defer a.mu.Unlock()
-	i := 0
-	for i < len(a.buckets) && a.buckets[i].sec <= cutoff {
-		i++
-	}
-	if i > 0 {
-		for j := 0; j < i; j++ {
-			a.buckets[j].stats = nil // GC 가능하도록 map 참조 해제
+	for si := range a.shards {
+		s := &a.shards[si]
+		s.mu.Lock()
+		i := 0
+		for i < len(s.buckets) && s.buckets[i].sec <= cutoff {
+			i++
+		}
+		if i > 0 {
+			for j := 0; j < i; j++ {
+				s.buckets[j].stats = nil // GC 가능하도록 map 참조 해제
+			}
+			s.buckets = s.buckets[i:]
 		}
-		a.buckets = a.buckets[i:]
+		s.mu.Unlock()
 	}
 }
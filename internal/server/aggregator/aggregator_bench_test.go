@@ -0,0 +1,69 @@
+package aggregator
+
+import (
+	"fmt"
+	"testing"
+
+	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
+	"github.com/gihongjo/nefi/internal/server/store"
+)
+
+// benchEvent는 record() hot path가 받는 전형적인 응답 이벤트다.
+func benchEvent(i int) *nefiv1.TraceEvent {
+	return &nefiv1.TraceEvent{
+		Namespace:  "default",
+		PodName:    fmt.Sprintf("api-6d4cf56db6-%05d", i),
+		HttpMethod: "GET",
+		HttpPath:   fmt.Sprintf("/api/users/%d", i%50),
+		HttpStatus: 200,
+		LatencyNs:  1_500_000,
+	}
+}
+
+func newBenchAggregator(b *testing.B) *Aggregator {
+	b.Helper()
+	a := New(store.New(16))
+	b.Cleanup(a.Close)
+	return a
+}
+
+func BenchmarkRecord(b *testing.B) {
+	a := newBenchAggregator(b)
+	ev := benchEvent(0)
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		a.record(ev)
+	}
+}
+
+// 실제 ingest처럼 여러 고루틴이 서로 다른 endpoint를 기록하는 경우 —
+// shard 경합을 본다.
+func BenchmarkRecordParallel(b *testing.B) {
+	a := newBenchAggregator(b)
+	b.ReportAllocs()
+	b.RunParallel(func(pb *testing.PB) {
+		i := 0
+		for pb.Next() {
+			a.record(benchEvent(i))
+			i++
+		}
+	})
+}
+
+func BenchmarkSnapshot(b *testing.B) {
+	for _, endpoints := range []int{100, 2500} {
+		b.Run(fmt.Sprintf("endpoints=%d", endpoints), func(b *testing.B) {
+			a := newBenchAggregator(b)
+			for i := 0; i < endpoints; i++ {
+				a.record(benchEvent(i))
+			}
+			b.ReportAllocs()
+			b.ResetTimer()
+			for i := 0; i < b.N; i++ {
+				if stats := a.Snapshot(DefaultWindowSec); len(stats) == 0 {
+					b.Fatal("empty snapshot")
+				}
+			}
+		})
+	}
+}
@@ -4,20 +4,40 @@
 //
 //	GET /healthz               — 헬스체크
 //	GET /api/stats?window=60   — aggregator 슬라이딩 윈도우 집계 결과
-//	GET /api/events?limit=100  — store 최근 이벤트 목록
+//	GET /api/events?limit=100  — store 최근 이벤트 목록 (namespace/pod/protocol/status_class 필터 지원)
+//
+// Sharded 배포 (--peers):
+//
+//	agent가 connection-affinity 해시로 이벤트를 replica들에 분산하면 각
+//	replica는 자기 몫만 집계한다. --peers로 나머지 replica를 알려주면
+//	/api/v1/stats와 /api/v1/topology가 peer들의 raw 엔드포인트
+//	(/api/v1/stats/raw, /api/v1/topology/raw)를 조회해 원시 카운터를
+//	합산한 뒤 비율/percentile을 계산한다 — 어느 replica에 물어봐도
+//	클러스터 전체 뷰가 나온다. raw 엔드포인트는 절대 peer로 fan-out하지
+//	않으므로 순환 조회가 없다.
 package api
 
 import (
+	"context"
+	"encoding/json"
 	"fmt"
+	"log"
 	"net/http"
+	"strings"
+	"time"
 
 	"github.com/gin-gonic/gin"
 
 	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
 	"github.com/gihongjo/nefi/internal/server/aggregator"
 	"github.com/gihongjo/nefi/internal/server/store"
+	"github.com/gihongjo/nefi/internal/server/topology"
 )
 
+// peerFetchTimeout은 peer raw 조회 제한 시간이다. peer가 죽어 있어도
+// 대시보드 응답이 이 이상 지연되지 않는다 (실패한 peer는 건너뛴다).
+const peerFetchTimeout = 2 * time.Second
+
 // ---- Request / Response 타입 ----
 
 type statsQuery struct {
@@ -25,7 +45,15 @@ type statsQuery struct {
 }
 
 type eventsQuery struct {
-	Limit int `form:"limit" binding:"omitempty,min=1,max=10000"`
+	Limit       int    `form:"limit" binding:"omitempty,min=1,max=10000"`
+	Namespace   string `form:"namespace"`
+	Pod         string `form:"pod"`
+	Protocol    uint32 `form:"protocol" binding:"omitempty,min=1,max=2"`
+	StatusClass int32  `form:"status_class" binding:"omitempty,min=2,max=5"`
+	// since_ns/until_ns는 wall clock UnixNano다. agent가 커널의
+	// boot-relative timestamp를 전송 시점에 UnixNano로 변환해 보낸다.
+	SinceNs uint64 `form:"since_ns"` // 0 = hot tier만 조회
+	UntilNs uint64 `form:"until_ns"` // 0 = 상한 없음 (since_ns와 함께 사용)
 }
 
 type statsResponse struct {
@@ -62,11 +90,21 @@ type eventResponse struct {
 type Handler struct {
 	store store.Store
 	agg   *aggregator.Aggregator
+	topo  *topology.Topology
+
+	peers      []string // sharded 배포의 다른 replica HTTP 주소 (자기 자신 제외)
+	peerClient *http.Client
 }
 
-// New는 Handler를 생성한다.
-func New(s store.Store, agg *aggregator.Aggregator) *Handler {
-	return &Handler{store: s, agg: agg}
+// New는 Handler를 생성한다. peers가 비어 있으면 단일 replica 모드다.
+func New(s store.Store, agg *aggregator.Aggregator, topo *topology.Topology, peers []string) *Handler {
+	return &Handler{
+		store:      s,
+		agg:        agg,
+		topo:       topo,
+		peers:      peers,
+		peerClient: &http.Client{Timeout: peerFetchTimeout},
+	}
 }
 
 // Register는 라우터에 엔드포인트를 등록한다.
@@ -77,8 +115,10 @@ func (h *Handler) Register(r gin.IRouter) {
 	v1 := r.Group("/api/v1")
 	{
 		v1.GET("/stats", h.getStats)
+		v1.GET("/stats/raw", h.getStatsRaw)
 		v1.GET("/events", h.getEvents)
 		v1.GET("/topology", h.getTopology)
+		v1.GET("/topology/raw", h.getTopologyRaw)
 	}
 }
 
@@ -99,14 +139,97 @@ func (h *Handler) getStats(c *gin.Context) {
 		q.Window = aggregator.DefaultWindowSec
 	}
 
+	endpoints := h.agg.Snapshot(q.Window)
+	if len(h.peers) > 0 {
+		endpoints = h.mergedStats(c.Request.Context(), q.Window)
+	}
 	c.JSON(http.StatusOK, statsResponse{
 		WindowSec: q.Window,
-		Endpoints: h.agg.Snapshot(q.Window),
+		Endpoints: endpoints,
+	})
+}
+
+// GET /api/v1/stats/raw?window=60
+// replica 간 merge용 원시 카운터. peer fan-out 없음 (순환 방지).
+func (h *Handler) getStatsRaw(c *gin.Context) {
+	var q statsQuery
+	if err := c.ShouldBindQuery(&q); err != nil {
+		c.JSON(http.StatusBadRequest, gin.H{"error": err.Error()})
+		return
+	}
+	if q.Window == 0 {
+		q.Window = aggregator.DefaultWindowSec
+	}
+	c.JSON(http.StatusOK, statsRawResponse{
+		WindowSec: q.Window,
+		Endpoints: h.agg.SnapshotRaw(q.Window),
 	})
 }
 
-// GET /api/v1/events?limit=100
-// limit: 1~10000, 기본값 100
+type statsRawResponse struct {
+	WindowSec int                          `json:"window_sec"`
+	Endpoints []aggregator.RawEndpointStat `json:"endpoints"`
+}
+
+// mergedStats는 로컬 + 모든 peer의 raw 카운터를 EndpointKey별로 합산한 뒤
+// EndpointStat로 변환한다. 비율/percentile은 합산이 끝난 후에만 계산해야
+// 단일 프로세스 집계와 같은 값이 나온다 (StatFor 주석 참고).
+func (h *Handler) mergedStats(ctx context.Context, windowSec int) []aggregator.EndpointStat {
+	merged := make(map[aggregator.EndpointKey]aggregator.Counts)
+	add := func(raws []aggregator.RawEndpointStat) {
+		for _, r := range raws {
+			m := merged[r.Key]
+			m.Merge(&r.Counts)
+			merged[r.Key] = m
+		}
+	}
+	add(h.agg.SnapshotRaw(windowSec))
+	for _, peer := range h.peers {
+		var resp statsRawResponse
+		if err := h.fetchPeer(ctx, peer, "/api/v1/stats/raw", windowSec, &resp); err != nil {
+			log.Printf("[api] peer %s stats fetch failed (skipping): %v", peer, err)
+			continue
+		}
+		add(resp.Endpoints)
+	}
+
+	result := make([]aggregator.EndpointStat, 0, len(merged))
+	for k, c := range merged {
+		result = append(result, aggregator.StatFor(k, &c))
+	}
+	return result
+}
+
+// fetchPeer는 peer의 raw 엔드포인트를 조회해 out으로 디코딩한다.
+func (h *Handler) fetchPeer(ctx context.Context, peer, path string, windowSec int, out any) error {
+	if !strings.Contains(peer, "://") {
+		peer = "http://" + peer
+	}
+	ctx, cancel := context.WithTimeout(ctx, peerFetchTimeout)
+	defer cancel()
+
+	url := fmt.Sprintf("%s%s?window=%d", peer, path, windowSec)
+	req, err := http.NewRequestWithContext(ctx, http.MethodGet, url, nil)
+	if err != nil {
+		return err
+	}
+	resp, err := h.peerClient.Do(req)
+	if err != nil {
+		return err
+	}
+	defer resp.Body.Close()
+	if resp.StatusCode != http.StatusOK {
+		return fmt.Errorf("unexpected status %d", resp.StatusCode)
+	}
+	if err := json.NewDecoder(resp.Body).Decode(out); err != nil {
+		return fmt.Errorf("decode response: %w", err)
+	}
+	return nil
+}
+
+// GET /api/v1/events?limit=100&namespace=&pod=&protocol=&status_class=
+// limit: 1~10000, 기본값 100. 필터 파라미터는 생략 시 전체를 뜻하며,
+// store의 보조 인덱스를 타므로 드릴다운에도 전체 스캔이 없다.
 func (h *Handler) getEvents(c *gin.Context) {
 	var q eventsQuery
 	if err := c.ShouldBindQuery(&q); err != nil {
@@ -117,7 +240,30 @@ func (h *Handler) getEvents(c *gin.Context) {
 		q.Limit = 100
 	}
 
-	events := h.store.Recent(q.Limit)
+	filter := store.Filter{
+		Namespace:   q.Namespace,
+		PodName:     q.Pod,
+		Protocol:    q.Protocol,
+		StatusClass: q.StatusClass,
+	}
+
+	var events []*nefiv1.TraceEvent
+	if q.SinceNs > 0 || q.UntilNs > 0 {
+		// 시간 범위 조회는 디스크 히스토리(RangeQuerier)가 필요하다.
+		rq, ok := h.store.(store.RangeQuerier)
+		if !ok {
+			c.JSON(http.StatusBadRequest, gin.H{"error": "range query requires persistent store (run nefi-server with --data-dir)"})
+			return
+		}
+		var err error
+		events, err = rq.QueryRange(q.SinceNs, q.UntilNs, filter, q.Limit)
+		if err != nil {
+			c.JSON(http.StatusInternalServerError, gin.H{"error": err.Error()})
+			return
+		}
+	} else {
+		events = h.store.Query(filter, q.Limit)
+	}
 	c.JSON(http.StatusOK, eventsResponse{
 		Count:  len(events),
 		Events: toEventList(events),
@@ -155,7 +301,7 @@ func toEventList(events []*nefiv1.TraceEvent) []eventResponse {
 // ---- Topology ----
 
 type topoQuery struct {
-	Limit int `form:"limit" binding:"omitempty,min=1,max=50000"`
+	Window int `form:"window" binding:"omitempty,min=1,max=300"`
 }
 
 type topoNode struct {
@@ -180,133 +326,49 @@ type topoResponse struct {
 	Edges []topoEdge `json:"edges"`
 }
 
-type edgeKey struct {
-	Src string
-	Dst string
-}
-
-type edgeCounts struct {
-	total        int64
-	success      int64
-	error        int64
-	latencySum   int64 // ns 누적
-	latencyCount int64
-}
-
-// GET /api/v1/topology?limit=5000
-// store의 최근 이벤트에서 workload 간 트래픽 토폴로지를 반환한다.
+// GET /api/v1/topology?window=60
+// window: 1~300 (초), 기본값 60
 //
-// 노드 식별 우선순위: K8s PodName > Comm (프로세스명)
-// 엣지 방향: 요청 방향 (A→B = A가 B를 호출함)
-//   - Direction 0(SEND, 응답 송신): 리모트(클라이언트)→로컬(서버) 요청 방향
-//   - Direction 1(RECV, 응답 수신): 로컬(클라이언트)→리모트(서버) 요청 방향
+// 그래프는 topology 인덱스가 store 구독으로 증분 유지한다 — 요청마다
+// 이벤트를 다시 스캔하지 않고 미리 접어 둔 엣지 카운터만 변환한다.
+// 노드/엣지 식별 규칙은 topology 패키지 주석 참고.
 func (h *Handler) getTopology(c *gin.Context) {
 	var q topoQuery
 	if err := c.ShouldBindQuery(&q); err != nil {
 		c.JSON(http.StatusBadRequest, gin.H{"error": err.Error()})
 		return
 	}
-	if q.Limit == 0 {
-		q.Limit = 5000
+	if q.Window == 0 {
+		q.Window = topology.DefaultWindowSec
 	}
 
-	events := h.store.Recent(q.Limit)
-
-	nodeSet := make(map[string]topoNode)
-	edgeMap := make(map[edgeKey]*edgeCounts)
-
-	for _, ev := range events {
-		if ev.HttpStatus == 0 {
-			continue
-		}
-
-		// 로컬 workload 식별: K8s PodName이 없으면 skip (호스트 프로세스 제외)
-		if ev.PodName == "" {
-			continue
-		}
-		localWorkload := aggregator.WorkloadName(ev.PodName)
-		localID := localWorkload
-		if ev.Namespace != "" {
-			localID = ev.Namespace + "/" + localWorkload
-		}
-
-		// 리모트 workload 식별: pod 이름 > pod IP 순서
-		remoteID := nodeID(ev.RemoteNs, ev.RemotePod)
-		if remoteID == "" {
-			if ev.RemoteIp != 0 {
-				remoteID = fmt.Sprintf("%d.%d.%d.%d",
-					(ev.RemoteIp>>24)&0xff, (ev.RemoteIp>>16)&0xff,
-					(ev.RemoteIp>>8)&0xff, ev.RemoteIp&0xff)
-			} else {
-				continue
-			}
-		}
-
-		if _, ok := nodeSet[localID]; !ok {
-			nodeSet[localID] = topoNode{
-				ID:        localID,
-				Namespace: ev.Namespace,
-				Workload:  localWorkload,
-			}
-		}
-		if _, ok := nodeSet[remoteID]; !ok {
-			nodeSet[remoteID] = topoNode{
-				ID:        remoteID,
-				Namespace: ev.RemoteNs,
-				Workload:  aggregator.WorkloadName(ev.RemotePod),
-			}
-		}
-
-		// 요청 방향 엣지: A→B = A가 B를 호출
-		// Direction 0(SEND=응답 송신): 로컬이 서버 → 요청은 리모트(클라이언트)→로컬(서버)
-		// Direction 1(RECV=응답 수신): 로컬이 클라이언트 → 요청은 로컬(클라이언트)→리모트(서버)
-		var src, dst string
-		if ev.Direction == 0 {
-			src, dst = remoteID, localID
-		} else {
-			src, dst = localID, remoteID
-		}
-
-		ek := edgeKey{Src: src, Dst: dst}
-		ec := edgeMap[ek]
-		if ec == nil {
-			ec = &edgeCounts{}
-			edgeMap[ek] = ec
-		}
-		ec.total++
-		if ev.HttpStatus >= 200 && ev.HttpStatus < 400 {
-			ec.success++
-		} else if ev.HttpStatus >= 400 {
-			ec.error++
-		}
-		if ev.LatencyNs > 0 {
-			ec.latencySum += int64(ev.LatencyNs)
-			ec.latencyCount++
-		}
+	topoNodes, topoEdges := h.topo.Snapshot(q.Window)
+	if len(h.peers) > 0 {
+		topoNodes, topoEdges = h.mergedTopology(c.Request.Context(), q.Window, topoNodes, topoEdges)
 	}
 
-	nodes := make([]topoNode, 0, len(nodeSet))
-	for _, n := range nodeSet {
-		nodes = append(nodes, n)
+	nodes := make([]topoNode, 0, len(topoNodes))
+	for _, n := range topoNodes {
+		nodes = append(nodes, topoNode{ID: n.ID, Namespace: n.Namespace, Workload: n.Workload})
 	}
 
-	edges := make([]topoEdge, 0, len(edgeMap))
-	for ek, ec := range edgeMap {
+	edges := make([]topoEdge, 0, len(topoEdges))
+	for _, e := range topoEdges {
 		rate := 0.0
-		if ec.total > 0 {
-			rate = float64(ec.success) / float64(ec.total) * 100
+		if e.Total > 0 {
+			rate = float64(e.Success) / float64(e.Total) * 100
 		}
 		avgLatencyMs := 0.0
-		if ec.latencyCount > 0 {
-			avgLatencyMs = float64(ec.latencySum) / float64(ec.latencyCount) / 1e6
+		if e.LatencyCount > 0 {
+			avgLatencyMs = float64(e.LatencySumNs) / float64(e.LatencyCount) / 1e6
 		}
 		edges = append(edges, topoEdge{
-			ID:           ek.Src + "->" + ek.Dst,
-			Source:       ek.Src,
-			Target:       ek.Dst,
-			Total:        ec.total,
-			Success:      ec.success,
-			Error:        ec.error,
+			ID:           e.Source + "->" + e.Target,
+			Source:       e.Source,
+			Target:       e.Target,
+			Total:        e.Total,
+			Success:      e.Success,
+			Error:        e.Error,
 			SuccessRate:  rate,
 			AvgLatencyMs: avgLatencyMs,
 		})
@@ -315,10 +377,67 @@ func (h *Handler) getTopology(c *gin.Context) {
 	c.JSON(http.StatusOK, topoResponse{Nodes: nodes, Edges: edges})
 }
 
-func nodeID(ns, podName string) string {
-	workload := aggregator.WorkloadName(podName)
-	if ns == "" {
-		return workload
+// GET /api/v1/topology/raw?window=60
+// replica 간 merge용 원시 그래프. peer fan-out 없음 (순환 방지).
+func (h *Handler) getTopologyRaw(c *gin.Context) {
+	var q topoQuery
+	if err := c.ShouldBindQuery(&q); err != nil {
+		c.JSON(http.StatusBadRequest, gin.H{"error": err.Error()})
+		return
+	}
+	if q.Window == 0 {
+		q.Window = topology.DefaultWindowSec
+	}
+	nodes, edges := h.topo.Snapshot(q.Window)
+	c.JSON(http.StatusOK, topoRawResponse{WindowSec: q.Window, Nodes: nodes, Edges: edges})
+}
+
+type topoRawResponse struct {
+	WindowSec int             `json:"window_sec"`
+	Nodes     []topology.Node `json:"nodes"`
+	Edges     []topology.Edge `json:"edges"`
+}
+
+// mergedTopology는 로컬 그래프에 peer들의 raw 그래프를 합친다.
+// 노드는 ID 기준 union, 엣지는 source→target 쌍 기준으로 원시 합을 더한다
+// (rate/평균은 getTopology가 합산 결과에서 계산).
+func (h *Handler) mergedTopology(ctx context.Context, windowSec int, localNodes []topology.Node, localEdges []topology.Edge) ([]topology.Node, []topology.Edge) {
+	type edgeID struct{ src, dst string }
+	mergedNodes := make(map[string]topology.Node)
+	mergedEdges := make(map[edgeID]topology.Edge)
+	add := func(nodes []topology.Node, edges []topology.Edge) {
+		for _, n := range nodes {
+			mergedNodes[n.ID] = n
+		}
+		for _, e := range edges {
+			k := edgeID{src: e.Source, dst: e.Target}
+			m := mergedEdges[k]
+			m.Source, m.Target = e.Source, e.Target
+			m.Total += e.Total
+			m.Success += e.Success
+			m.Error += e.Error
+			m.LatencySumNs += e.LatencySumNs
+			m.LatencyCount += e.LatencyCount
+			mergedEdges[k] = m
+		}
+	}
+	add(localNodes, localEdges)
+	for _, peer := range h.peers {
+		var resp topoRawResponse
+		if err := h.fetchPeer(ctx, peer, "/api/v1/topology/raw", windowSec, &resp); err != nil {
+			log.Printf("[api] peer %s topology fetch failed (skipping): %v", peer, err)
+			continue
+		}
+		add(resp.Nodes, resp.Edges)
+	}
+
+	nodes := make([]topology.Node, 0, len(mergedNodes))
+	for _, n := range mergedNodes {
+		nodes = append(nodes, n)
+	}
+	edges := make([]topology.Edge, 0, len(mergedEdges))
+	for _, e := range mergedEdges {
+		edges = append(edges, e)
 	}
-	return ns + "/" + workload
+	return nodes, edges
 }
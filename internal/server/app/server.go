@@ -8,11 +8,14 @@ import (
 	"log"
 	"net"
 	"net/http"
+	"strings"
 	"time"
 
 	"github.com/gin-contrib/cors"
 	"github.com/gin-gonic/gin"
 	"google.golang.org/grpc"
+	// agent가 배치 스트림에 gzip 압축을 쓰므로 decompressor를 등록한다.
+	_ "google.golang.org/grpc/encoding/gzip"
 
 	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
 	"github.com/gihongjo/nefi/internal/server/aggregator"
@@ -20,6 +23,7 @@ import (
 	"github.com/gihongjo/nefi/internal/server/collector"
 	"github.com/gihongjo/nefi/internal/server/hub"
 	"github.com/gihongjo/nefi/internal/server/store"
+	"github.com/gihongjo/nefi/internal/server/topology"
 	"github.com/gihongjo/nefi/web"
 )
 
@@ -28,6 +32,19 @@ type Config struct {
 	GRPCAddr string
 	HTTPAddr string
 	Capacity int
+	DataDir  string // 비어 있으면 인메모리 전용 (재시작 시 이벤트 소실)
+	Peers    string // sharded 배포의 다른 replica HTTP 주소 (쉼표 구분, 자기 자신 제외)
+}
+
+// peerList는 쉼표 구분 Peers 문자열을 주소 슬라이스로 정리한다.
+func peerList(peers string) []string {
+	var out []string
+	for _, p := range strings.Split(peers, ",") {
+		if p = strings.TrimSpace(p); p != "" {
+			out = append(out, p)
+		}
+	}
+	return out
 }
 
 // Server는 nefi-server의 모든 컴포넌트를 소유한다.
@@ -35,6 +52,7 @@ type Server struct {
 	cfg     Config
 	store   store.Store
 	agg     *aggregator.Aggregator
+	topo    *topology.Topology
 	hub     *hub.Hub
 	grpcSrv *grpc.Server
 	grpcLis net.Listener
@@ -45,14 +63,25 @@ type Server struct {
 // 실제 요청 처리는 Run() 호출 이후 시작된다.
 func New(cfg Config) (*Server, error) {
 
-	s := store.New(cfg.Capacity)
+	var s store.Store
+	if cfg.DataDir != "" {
+		var err error
+		s, err = store.NewPersistent(cfg.DataDir, cfg.Capacity)
+		if err != nil {
+			return nil, fmt.Errorf("open persistent store %s: %w", cfg.DataDir, err)
+		}
+	} else {
+		s = store.New(cfg.Capacity)
+	}
 	agg := aggregator.New(s)
+	topo := topology.New(s)
 	h := hub.New(s, agg)
 
 	grpcLis, err := net.Listen("tcp", cfg.GRPCAddr)
 	if err != nil {
 		s.Close()
 		agg.Close()
+		topo.Close()
 		h.Close()
 		return nil, fmt.Errorf("gRPC listen %s: %w", cfg.GRPCAddr, err)
 	}
@@ -62,7 +91,7 @@ func New(cfg Config) (*Server, error) {
 	gin.SetMode(gin.ReleaseMode)
 	r := gin.New()
 	r.Use(cors.Default(), gin.Logger(), gin.Recovery())
-	api.New(s, agg).Register(r)
+	api.New(s, agg, topo, peerList(cfg.Peers)).Register(r)
 	r.GET("/ws", gin.WrapH(h))
 
 	// Svelte 빌드 결과물 (web/dist/) 서빙
@@ -82,6 +111,7 @@ func New(cfg Config) (*Server, error) {
 		cfg:     cfg,
 		store:   s,
 		agg:     agg,
+		topo:    topo,
 		hub:     h,
 		grpcSrv: grpcSrv,
 		grpcLis: grpcLis,
@@ -140,6 +170,7 @@ func (s *Server) shutdown(cause error) error {
 	// 외부 네트워크 연결 종료 후 내부 컴포넌트 정리
 	s.hub.Close()
 	s.agg.Close()
+	s.topo.Close()
 	s.store.Close()
 
 	return cause
@@ -4,6 +4,14 @@
 //   NefiCollector.SendEvents: agent가 클라이언트 스트리밍으로 TraceEvent를 push하면
 //   HTTP 요청/응답을 연결(fd)단위로 추적해 메타데이터를 보강한 뒤 Store에 저장한다.
 //
+// 파이프라인:
+//   recv 단계(스트림당 고루틴)는 이벤트를 connKey 해시로 enrichment worker
+//   풀에 라우팅만 하고, 파싱(httpparse)과 store 커밋은 worker가 수행한다.
+//   같은 연결의 이벤트는 항상 같은 worker로 가므로 요청→응답 순서가
+//   유지되고, ingest 처리량은 스트림당 고루틴 하나가 아니라 코어 수에
+//   비례한다. worker 채널이 차면 recv가 블로킹된다 — gRPC 흐름제어를 통해
+//   agent 쪽으로 backpressure가 전파되고 이벤트는 drop되지 않는다.
+//
 // HTTP 연결 추적:
 //   요청 이벤트(method/path 있음, status 없음) → connTracker에 {pod, pid, fd} → {method, path} 저장
 //   응답 이벤트(status 있음, method 없음)      → connTracker에서 꺼내 method/path 채움
@@ -13,6 +21,7 @@ package collector
 import (
 	"io"
 	"log"
+	"runtime"
 
 	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
 	"github.com/gihongjo/nefi/internal/server/httpparse"
@@ -20,22 +29,36 @@ import (
 	"google.golang.org/grpc/peer"
 )
 
+const (
+	workerChanSize = 1024 // worker당 대기 큐 (recv 버스트 흡수)
+	maxCommitBatch = 128  // store.AddBatch 한 번에 커밋하는 최대 이벤트 수
+)
+
 // Service는 NefiCollectorServer 인터페이스를 구현한다.
 type Service struct {
 	nefiv1.UnimplementedNefiCollectorServer
 	store   store.Store
 	tracker *connTracker
+	workers []chan *nefiv1.TraceEvent // enrichment worker 입력 큐 (connKey 해시로 라우팅)
 }
 
 // New는 주어진 Store를 사용하는 CollectorService를 반환한다.
+// enrichment worker는 코어 수만큼 만들어 모든 agent 스트림이 공유한다.
 func New(s store.Store) *Service {
-	return &Service{
+	svc := &Service{
 		store:   s,
 		tracker: newConnTracker(),
+		workers: make([]chan *nefiv1.TraceEvent, runtime.GOMAXPROCS(0)),
+	}
+	for i := range svc.workers {
+		svc.workers[i] = make(chan *nefiv1.TraceEvent, workerChanSize)
+		go svc.enrichWorker(svc.workers[i])
 	}
+	return svc
 }
 
-// SendEvents는 agent의 이벤트 스트림을 수신한다.
+// SendEvents는 agent의 이벤트 배치 스트림을 수신한다.
+// recv 단계는 라우팅만 담당한다 — 느린 파싱이 스트림 recv를 막지 않는다.
 func (s *Service) SendEvents(stream nefiv1.NefiCollector_SendEventsServer) error {
 	addr := ""
 	if p, ok := peer.FromContext(stream.Context()); ok {
@@ -45,7 +68,7 @@ func (s *Service) SendEvents(stream nefiv1.NefiCollector_SendEventsServer) error
 
 	var received uint64
 	for {
-		event, err := stream.Recv()
+		batch, err := stream.Recv()
 		if err == io.EOF {
 			break
 		}
@@ -53,26 +76,65 @@ func (s *Service) SendEvents(stream nefiv1.NefiCollector_SendEventsServer) error
 			log.Printf("[collector] stream error from %s: %v", addr, err)
 			return err
 		}
-		s.enrichHTTP(event)
-		s.store.Add(event)
-		received++
+		for _, event := range batch.Events {
+			key := connKey{PodName: event.PodName, PID: event.Pid, FD: event.Fd}
+			s.workers[key.hash()%uint32(len(s.workers))] <- event
+			received++
+		}
 	}
 
 	log.Printf("[collector] agent %s disconnected — received %d events", addr, received)
 	return stream.SendAndClose(&nefiv1.CollectSummary{Received: received})
 }
 
+// enrichWorker는 자기 큐의 이벤트를 enrich하고 배치로 store에 커밋한다.
+// 블로킹으로 첫 이벤트를 기다린 뒤 큐에 쌓인 것을 maxCommitBatch까지
+// non-blocking으로 drain해 AddBatch 한 번(락 한 번)으로 커밋한다.
+func (s *Service) enrichWorker(ch chan *nefiv1.TraceEvent) {
+	batch := make([]*nefiv1.TraceEvent, 0, maxCommitBatch)
+	for ev := range ch {
+		s.enrichHTTP(ev)
+		batch = append(batch, ev)
+	drain:
+		for len(batch) < maxCommitBatch {
+			select {
+			case next, ok := <-ch:
+				if !ok {
+					break drain
+				}
+				s.enrichHTTP(next)
+				batch = append(batch, next)
+			default:
+				break drain
+			}
+		}
+		s.store.AddBatch(batch)
+		batch = batch[:0]
+	}
+}
+
 // enrichHTTP는 HTTP 이벤트의 payload를 파싱해 메타데이터 필드를 채운다.
 //
 // 요청 이벤트: method/path를 connTracker에 저장.
 // 응답 이벤트: connTracker에서 같은 연결의 method/path를 꺼내 채움.
+//
+// HTTP/2(protocol=2)도 같은 경로를 탄다 — hpack uprobe가 HTTP/1 스타일
+// start-line으로 합성해 보내므로 payload 파싱이 그대로 동작한다. 단,
+// uprobe 이벤트는 FD를 모르기 때문에(fd=0) 요청/응답 매핑은 (pod, pid)
+// 단위가 된다.
 func (s *Service) enrichHTTP(event *nefiv1.TraceEvent) {
-	if event.Protocol != 1 {
+	if event.Protocol != 1 && event.Protocol != 2 {
 		return
 	}
-	parsed := httpparse.Parse(event.Payload)
-	if parsed == nil {
-		return
+	// 스택의 Result를 재사용하는 zero-allocation 스캐너를 먼저 시도하고,
+	// 비정형 메시지만 net/http 폴백이 포함된 Parse로 넘긴다.
+	var result httpparse.Result
+	parsed := &result
+	if !httpparse.ParseInto(event.Payload, parsed) {
+		parsed = httpparse.Parse(event.Payload)
+		if parsed == nil {
+			return
+		}
 	}
 
 	key := connKey{PodName: event.PodName, PID: event.Pid, FD: event.Fd}
@@ -93,7 +155,9 @@ func (s *Service) enrichHTTP(event *nefiv1.TraceEvent) {
 		if method, path, reqTs, ok := s.tracker.pop(key); ok {
 			event.HttpMethod = method
 			event.HttpPath = path
-			if reqTs > 0 && event.TimestampNs >= reqTs {
+			// 커널이 이미 페어링한 latency가 있으면 그 값을 우선한다.
+			// (bpf_ktime_get_ns 기준이라 유저스페이스 타임스탬프 차보다 정확)
+			if event.LatencyNs == 0 && reqTs > 0 && event.TimestampNs >= reqTs {
 				event.LatencyNs = event.TimestampNs - reqTs
 			}
 		}
@@ -5,7 +5,19 @@ import (
 	"time"
 )
 
-const connTTL = 30 * time.Second
+const (
+	connTTL = 30 * time.Second
+
+	// trackerShards는 connKey 해시로 나누는 shard 수다 (2의 거듭제곱).
+	// set/pop이 자기 shard만 잠그므로 agent 스트림 수만큼 병렬로 동작한다.
+	trackerShards = 16
+
+	// Timing wheel: 1초 슬롯 × 64칸 (> connTTL). set 시점에 만료 슬롯에
+	// 키를 넣어 두고, 만료 루프는 현재 슬롯의 키만 확인한다 —
+	// 전체 맵 스캔(O(all))이 아니라 O(만료 대상)이다.
+	wheelSlotDur = time.Second
+	wheelSlots   = 64
+)
 
 // connKey는 하나의 TCP 연결을 식별하는 키다.
 // 동일 fd가 다른 연결에 재사용될 수 있으므로 PodName+PID+FD 조합을 사용한다.
@@ -15,63 +27,120 @@ type connKey struct {
 	FD      uint32
 }
 
+// hash는 connKey의 FNV-1a 해시다. tracker shard 선택과 collector의
+// enrichment worker 라우팅(같은 연결 → 같은 worker)이 공유한다.
+func (k *connKey) hash() uint32 {
+	const (
+		offset32 = 2166136261
+		prime32  = 16777619
+	)
+	h := uint32(offset32)
+	for i := 0; i < len(k.PodName); i++ {
+		h ^= uint32(k.PodName[i])
+		h *= prime32
+	}
+	for _, v := range [...]uint32{k.PID, k.FD} {
+		h ^= v & 0xff
+		h *= prime32
+		h ^= (v >> 8) & 0xff
+		h *= prime32
+		h ^= (v >> 16) & 0xff
+		h *= prime32
+		h ^= v >> 24
+		h *= prime32
+	}
+	return h
+}
+
+// shardIndex는 connKey가 속한 tracker shard 인덱스다.
+func (k *connKey) shardIndex() uint32 {
+	return k.hash() & (trackerShards - 1)
+}
+
 type connEntry struct {
-	method          string
-	path            string
-	reqTimestampNs  uint64
-	expiresAt       time.Time
+	method         string
+	path           string
+	reqTimestampNs uint64
+	expiresAt      int64 // unix ns
+}
+
+// trackerShard는 독립된 캐시 + timing wheel 한 벌이다.
+type trackerShard struct {
+	mu    sync.Mutex
+	cache map[connKey]connEntry
+	wheel [wheelSlots][]connKey
 }
 
 // connTracker는 HTTP 요청(method/path)을 fd 단위로 캐시해두고,
 // 응답 이벤트가 오면 해당 요청의 메타데이터를 꺼내 쓸 수 있게 한다.
 type connTracker struct {
-	mu    sync.Mutex
-	cache map[connKey]connEntry
+	shards [trackerShards]trackerShard
 }
 
 func newConnTracker() *connTracker {
-	t := &connTracker{cache: make(map[connKey]connEntry)}
-	go t.cleanup()
+	t := &connTracker{}
+	for i := range t.shards {
+		t.shards[i].cache = make(map[connKey]connEntry)
+	}
+	go t.expireLoop()
 	return t
 }
 
-// set은 요청 이벤트의 method/path/timestamp를 연결 키에 저장한다.
+// set은 요청 이벤트의 method/path/timestamp를 연결 키에 저장하고,
+// 만료 시각이 속한 wheel 슬롯에 키를 등록한다.
 func (t *connTracker) set(key connKey, method, path string, reqTimestampNs uint64) {
-	t.mu.Lock()
-	t.cache[key] = connEntry{
+	now := time.Now()
+	expiresAt := now.Add(connTTL)
+	slot := (expiresAt.UnixNano() / int64(wheelSlotDur)) % wheelSlots
+
+	s := &t.shards[key.shardIndex()]
+	s.mu.Lock()
+	s.cache[key] = connEntry{
 		method:         method,
 		path:           path,
 		reqTimestampNs: reqTimestampNs,
-		expiresAt:      time.Now().Add(connTTL),
+		expiresAt:      expiresAt.UnixNano(),
 	}
-	t.mu.Unlock()
+	// 같은 키가 재등록되면 이전 슬롯에 stale 참조가 남지만, 만료 시점에
+	// expiresAt 비교로 걸러진다 — pop된 키도 마찬가지로 무해하다.
+	s.wheel[slot] = append(s.wheel[slot], key)
+	s.mu.Unlock()
 }
 
 // pop은 연결 키에 저장된 method/path/timestamp를 꺼내고 캐시에서 제거한다.
+// wheel의 참조는 그대로 두고 만료 시점에 걸러낸다 (슬롯 탐색 비용 회피).
 func (t *connTracker) pop(key connKey) (method, path string, reqTimestampNs uint64, ok bool) {
-	t.mu.Lock()
-	defer t.mu.Unlock()
-	e, exists := t.cache[key]
+	s := &t.shards[key.shardIndex()]
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	e, exists := s.cache[key]
 	if !exists {
 		return "", "", 0, false
 	}
-	delete(t.cache, key)
+	delete(s.cache, key)
 	return e.method, e.path, e.reqTimestampNs, true
 }
 
-// cleanup은 10초마다 만료된 항목을 제거한다.
+// expireLoop는 wheelSlotDur마다 현재 슬롯에 등록된 키만 확인해 만료한다.
 // 응답 없이 연결이 끊긴 경우의 메모리 누수를 방지한다.
-func (t *connTracker) cleanup() {
-	ticker := time.NewTicker(10 * time.Second)
+func (t *connTracker) expireLoop() {
+	ticker := time.NewTicker(wheelSlotDur)
 	defer ticker.Stop()
-	for range ticker.C {
-		now := time.Now()
-		t.mu.Lock()
-		for k, e := range t.cache {
-			if now.After(e.expiresAt) {
-				delete(t.cache, k)
+	for now := range ticker.C {
+		nowNs := now.UnixNano()
+		slot := (nowNs / int64(wheelSlotDur)) % wheelSlots
+		for i := range t.shards {
+			s := &t.shards[i]
+			s.mu.Lock()
+			keys := s.wheel[slot]
+			s.wheel[slot] = nil
+			for _, k := range keys {
+				// pop됐거나 더 늦은 만료로 재등록된 엔트리는 건너뛴다.
+				if e, exists := s.cache[k]; exists && e.expiresAt <= nowNs {
+					delete(s.cache, k)
+				}
 			}
+			s.mu.Unlock()
 		}
-		t.mu.Unlock()
 	}
 }
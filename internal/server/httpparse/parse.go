@@ -4,6 +4,15 @@
 //   - 요청: method, path, content-type
 //   - 응답: status_code, content-type
 //
+// 성능:
+//   Result에 필요한 것은 네 필드뿐인데 net/http.ReadRequest/ReadResponse는
+//   이벤트마다 bufio.Reader, 헤더 맵, URL 파싱까지 만들어 enrichment hot
+//   path의 최대 할당 지점이었다. ParseInto는 바이트 슬라이스를 직접
+//   스캔한다 — method와 흔한 Content-Type은 interning된 상수 문자열이라
+//   응답 파싱은 할당이 0이고, 요청은 path 문자열 1개만 할당한다.
+//   스캐너가 처리하지 못하는 비정형 메시지는 기존 net/http 경로로
+//   폴백한다.
+//
 // 보안: Authorization, Cookie, Set-Cookie 헤더는 [REDACTED]로 마스킹한다.
 package httpparse
 
@@ -25,24 +34,189 @@ type Result struct {
 
 // Parse는 raw payload를 파싱해 HTTP 메타데이터를 반환한다.
 // HTTP가 아닌 경우 nil을 반환한다.
+//
+// hot path에서는 Result 재사용이 가능한 ParseInto를 쓰는 편이
+// 할당 하나를 더 아낀다 (반환 포인터는 escape한다).
 func Parse(payload []byte) *Result {
-	if len(payload) < 4 {
-		return nil
+	var r Result
+	if ParseInto(payload, &r) {
+		return &r
 	}
 
-	// 응답 판별: "HTTP/"로 시작
+	// 스캐너가 거부한 비정형 메시지 — net/http로 폴백
 	if bytes.HasPrefix(payload, []byte("HTTP/")) {
 		return parseResponse(payload)
 	}
-
-	// 요청 판별: 알려진 HTTP 메서드로 시작
 	if isHTTPRequest(payload) {
 		return parseRequest(payload)
 	}
-
 	return nil
 }
 
+// ParseInto는 payload를 직접 스캔해 r을 채운다. HTTP로 파싱되면 true를
+// 반환한다. false를 반환한 경우 r의 내용은 정의되지 않는다.
+// 할당: 응답은 0, 요청은 path 문자열 1개.
+func ParseInto(payload []byte, r *Result) bool {
+	*r = Result{}
+	if len(payload) < 4 {
+		return false
+	}
+	if payload[0] == 'H' && bytes.HasPrefix(payload, []byte("HTTP/")) {
+		return scanResponse(payload, r)
+	}
+	return scanRequest(payload, r)
+}
+
+// scanRequest는 "METHOD SP path ..." 요청 라인을 스캔한다.
+func scanRequest(payload []byte, r *Result) bool {
+	method := matchMethod(payload)
+	if method == "" {
+		return false
+	}
+
+	// path: method+space 이후부터 다음 공백(또는 줄 끝)까지
+	start := len(method) + 1
+	end := start
+	for end < len(payload) {
+		c := payload[end]
+		if c == ' ' || c == '\r' || c == '\n' {
+			break
+		}
+		end++
+	}
+	if end == start {
+		return false
+	}
+
+	r.Method = method // interning된 상수 — 할당 없음
+	r.Path = string(payload[start:end])
+	r.ContentType = scanContentType(payload)
+	return true
+}
+
+// scanResponse는 "HTTP/x.x NNN ..." 상태 라인을 스캔한다.
+func scanResponse(payload []byte, r *Result) bool {
+	sp := bytes.IndexByte(payload, ' ')
+	if sp < 0 || sp+3 >= len(payload) {
+		return false
+	}
+	code := int32(0)
+	i := sp + 1
+	for ; i < len(payload) && payload[i] >= '0' && payload[i] <= '9'; i++ {
+		code = code*10 + int32(payload[i]-'0')
+	}
+	if i == sp+1 || code < 100 || code > 999 {
+		return false
+	}
+
+	r.StatusCode = code
+	r.ContentType = scanContentType(payload)
+	return true
+}
+
+// scanContentType은 헤더 블록에서 Content-Type 값(mime 타입만)을 찾는다.
+// 흔한 타입은 interning된 상수를 반환해 할당을 피한다.
+func scanContentType(payload []byte) string {
+	// 첫 줄을 건너뛰고 빈 줄(헤더 끝)까지 라인 단위로 스캔
+	i := bytes.IndexByte(payload, '\n')
+	if i < 0 {
+		return ""
+	}
+	i++
+	for i < len(payload) {
+		end := bytes.IndexByte(payload[i:], '\n')
+		var line []byte
+		if end < 0 {
+			line = payload[i:]
+			i = len(payload)
+		} else {
+			line = payload[i : i+end]
+			i += end + 1
+		}
+		if len(line) > 0 && line[len(line)-1] == '\r' {
+			line = line[:len(line)-1]
+		}
+		if len(line) == 0 {
+			return "" // 헤더 끝 — Content-Type 없음
+		}
+		const name = "content-type:"
+		if len(line) > len(name) && asciiFoldPrefix(line, name) {
+			val := line[len(name):]
+			// leading space / 끝의 ";charset=..." 제거
+			for len(val) > 0 && (val[0] == ' ' || val[0] == '\t') {
+				val = val[1:]
+			}
+			if semi := bytes.IndexByte(val, ';'); semi >= 0 {
+				val = val[:semi]
+			}
+			for len(val) > 0 && (val[len(val)-1] == ' ' || val[len(val)-1] == '\t') {
+				val = val[:len(val)-1]
+			}
+			return internContentType(val)
+		}
+	}
+	return ""
+}
+
+// asciiFoldPrefix는 line이 소문자 prefix로 시작하는지 대소문자 무시 비교한다.
+// 호출자가 len(line) > len(prefix)를 보장한다.
+func asciiFoldPrefix(line []byte, prefix string) bool {
+	for i := 0; i < len(prefix); i++ {
+		c := line[i]
+		if c >= 'A' && c <= 'Z' {
+			c += 'a' - 'A'
+		}
+		if c != prefix[i] {
+			return false
+		}
+	}
+	return true
+}
+
+// httpMethods의 순서는 관측 빈도순이다 (GET/POST가 대부분).
+var httpMethods = []string{
+	"GET", "POST", "PUT", "DELETE", "PATCH",
+	"HEAD", "OPTIONS", "CONNECT", "TRACE",
+}
+
+// matchMethod는 payload가 "METHOD "로 시작하면 interning된 method 상수를
+// 반환한다. 없으면 "".
+func matchMethod(payload []byte) string {
+	for _, m := range httpMethods {
+		if len(payload) > len(m) && payload[len(m)] == ' ' &&
+			string(payload[:len(m)]) == m { // 비교용 변환은 컴파일러가 할당 없이 처리
+			return m
+		}
+	}
+	return ""
+}
+
+// commonContentTypes는 interning 대상이다. 목록에 없는 타입은 새 문자열을
+// 할당해 반환한다 (드문 경로).
+var commonContentTypes = []string{
+	"application/json",
+	"application/grpc",
+	"application/x-www-form-urlencoded",
+	"application/octet-stream",
+	"application/xml",
+	"application/javascript",
+	"text/html",
+	"text/plain",
+	"text/css",
+	"text/xml",
+}
+
+func internContentType(val []byte) string {
+	for _, ct := range commonContentTypes {
+		if string(val) == ct { // 비교용 변환은 컴파일러가 할당 없이 처리
+			return ct
+		}
+	}
+	return string(val)
+}
+
+// ─── net/http fallback (비정형 메시지) ──────────────────────────
+
 func parseRequest(payload []byte) *Result {
 	r, err := http.ReadRequest(bufio.NewReader(bytes.NewReader(payload)))
 	if err != nil {
@@ -113,16 +287,6 @@ func firstLine(payload []byte) string {
 	return strings.TrimRight(string(payload[:idx]), "\r")
 }
 
-var httpMethods = []string{
-	"GET ", "POST ", "PUT ", "DELETE ", "PATCH ",
-	"HEAD ", "OPTIONS ", "CONNECT ", "TRACE ",
-}
-
 func isHTTPRequest(payload []byte) bool {
-	for _, m := range httpMethods {
-		if bytes.HasPrefix(payload, []byte(m)) {
-			return true
-		}
-	}
-	return false
+	return matchMethod(payload) != ""
 }
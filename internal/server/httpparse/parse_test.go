@@ -62,6 +62,90 @@ func TestParseNonHTTP(t *testing.T) {
 	}
 }
 
+func TestParseIntoRequest(t *testing.T) {
+	payload := []byte("GET /api/users?page=1 HTTP/1.1\r\nHost: example.com\r\nContent-Type: application/json; charset=utf-8\r\n\r\n")
+	var r httpparse.Result
+	if !httpparse.ParseInto(payload, &r) {
+		t.Fatal("expected ParseInto to succeed")
+	}
+	if r.Method != "GET" || r.Path != "/api/users?page=1" || r.ContentType != "application/json" {
+		t.Errorf("unexpected result: %+v", r)
+	}
+}
+
+func TestParseIntoNonHTTP(t *testing.T) {
+	var r httpparse.Result
+	if httpparse.ParseInto([]byte("\x16\x03\x01\x00\x00"), &r) {
+		t.Error("expected ParseInto to reject non-HTTP payload")
+	}
+}
+
+func TestParseCaseInsensitiveContentType(t *testing.T) {
+	payload := []byte("HTTP/1.1 200 OK\r\ncontent-TYPE: TEXT/csv\r\n\r\n")
+	r := httpparse.Parse(payload)
+	if r == nil {
+		t.Fatal("expected non-nil result")
+	}
+	if r.ContentType != "TEXT/csv" {
+		t.Errorf("content-type: got %q, want TEXT/csv", r.ContentType)
+	}
+}
+
+// TestParseIntoResponseZeroAlloc은 응답 fast path가 할당 없이 동작함을
+// 보장한다 — method도 path도 없고 Content-Type은 interning되기 때문이다.
+func TestParseIntoResponseZeroAlloc(t *testing.T) {
+	payload := []byte("HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 42\r\n\r\n{}")
+	var r httpparse.Result
+	allocs := testing.AllocsPerRun(100, func() {
+		if !httpparse.ParseInto(payload, &r) {
+			t.Fatal("expected ParseInto to succeed")
+		}
+	})
+	if allocs != 0 {
+		t.Errorf("response fast path: got %v allocs/op, want 0", allocs)
+	}
+}
+
+// 요청은 path 문자열 1개만 허용된다.
+func TestParseIntoRequestOneAlloc(t *testing.T) {
+	payload := []byte("POST /api/login HTTP/1.1\r\nContent-Type: application/json\r\n\r\n{}")
+	var r httpparse.Result
+	allocs := testing.AllocsPerRun(100, func() {
+		if !httpparse.ParseInto(payload, &r) {
+			t.Fatal("expected ParseInto to succeed")
+		}
+	})
+	if allocs > 1 {
+		t.Errorf("request fast path: got %v allocs/op, want <= 1 (path string only)", allocs)
+	}
+}
+
+func BenchmarkParseIntoRequest(b *testing.B) {
+	payload := []byte("GET /api/users?page=1 HTTP/1.1\r\nHost: example.com\r\nContent-Type: application/json; charset=utf-8\r\n\r\n")
+	var r httpparse.Result
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		httpparse.ParseInto(payload, &r)
+	}
+}
+
+func BenchmarkParseIntoResponse(b *testing.B) {
+	payload := []byte("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 42\r\n\r\n{}")
+	var r httpparse.Result
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		httpparse.ParseInto(payload, &r)
+	}
+}
+
+func BenchmarkParseResponse(b *testing.B) {
+	payload := []byte("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 42\r\n\r\n{}")
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		httpparse.Parse(payload)
+	}
+}
+
 func TestParsePostRequest(t *testing.T) {
 	payload := []byte("POST /api/login HTTP/1.1\r\nHost: example.com\r\nContent-Type: application/json\r\nContent-Length: 30\r\n\r\n{\"username\":\"user\",\"password\":\"x\"}")
 	r := httpparse.Parse(payload)
@@ -2,18 +2,35 @@
 //
 // 메시지 타입 (type 필드로 구분):
 //   {"type":"event", ...}  — raw 캡처 이벤트 (실시간)
-//   {"type":"stats", "window_sec":60, "endpoints":[...]}  — 1초마다 슬라이딩 윈도우 집계
+//   {"type":"stats", "window_sec":60, "endpoints":[...]}  — 전체 스냅샷 keyframe
+//     (연결 직후 1회 + 10초마다)
+//   {"type":"stats_delta", "window_sec":60, "changed":[...], "removed":[...]}
+//     — 직전 tick 이후 카운터가 바뀐 endpoint만 (1초마다, 변화 없으면 생략)
+//
+// 클라이언트 → 서버:
+//   {"type":"subscribe", "namespace":"", "workload":"", "protocol":0}
+//     — 이후 event/stats를 해당 범위로 줄인다. 빈 필드는 전체, 빈 subscribe는
+//     필터 해제. 필터는 직렬화 전에 서버에서 적용된다.
 //
 // WebSocket 엔드포인트: GET /ws
 //   - 연결 시 최근 100개 이벤트를 먼저 전송 (히스토리)
 //   - 이후 실시간 이벤트 + 매 1초 통계 스트리밍
+//
+// 직렬화/전송 비용:
+//   메시지는 websocket.PreparedMessage로 한 번만 marshal + 프레이밍되고
+//   모든 클라이언트 send 채널이 같은 버퍼를 공유한다 — 세션 30개가 열려
+//   있어도 encoding/json은 이벤트당 한 번만 돈다. 고빈도 event 메시지는
+//   subprotocol "nefi.bin.v1"을 요청한 클라이언트에 한해 compact binary
+//   프레임으로 내려간다. stats 메시지는 UI 그래프 호환을 위해 항상 JSON이다.
 package hub
 
 import (
+	"encoding/binary"
 	"encoding/json"
 	"log"
 	"net/http"
 	"sync"
+	"sync/atomic"
 	"time"
 
 	"github.com/gorilla/websocket"
@@ -29,10 +46,19 @@ const (
 	pongWait       = 60 * time.Second
 	pingPeriod     = (pongWait * 9) / 10
 	maxMessageSize = 512
+
+	// keyframeEvery tick마다 delta 대신 전체 스냅샷을 보낸다 — 중간에
+	// delta를 놓친(드롭된) 클라이언트가 이 주기 안에 다시 동기화된다.
+	keyframeEvery = 10
 )
 
+// binaryProtocol은 event 메시지를 binary 프레임으로 받겠다는 subprotocol이다.
+// 요청하지 않은 클라이언트는 기존 JSON 텍스트 프레임을 받는다.
+const binaryProtocol = "nefi.bin.v1"
+
 var upgrader = websocket.Upgrader{
-	CheckOrigin: func(r *http.Request) bool { return true }, // 개발 편의상 전체 허용
+	CheckOrigin:  func(r *http.Request) bool { return true }, // 개발 편의상 전체 허용
+	Subprotocols: []string{binaryProtocol},
 }
 
 // WsEvent는 raw 이벤트 WebSocket 메시지다. Type은 항상 "event".
@@ -60,13 +86,80 @@ type WsEvent struct {
 	HttpContentType string `json:"http_content_type,omitempty"`
 }
 
-// WsStats는 슬라이딩 윈도우 집계 결과 WebSocket 메시지다. Type은 항상 "stats".
+// WsStats는 슬라이딩 윈도우 집계 전체 스냅샷(keyframe) 메시지다. Type은 항상 "stats".
 type WsStats struct {
 	Type      string                    `json:"type"`       // "stats"
 	WindowSec int                       `json:"window_sec"` // 집계 윈도우 (초)
 	Endpoints []aggregator.EndpointStat `json:"endpoints"`
 }
 
+// WsStatKey는 delta 메시지에서 사라진 endpoint를 지칭하는 키다.
+type WsStatKey struct {
+	Namespace    string `json:"namespace"`
+	WorkloadName string `json:"workload_name"`
+	PodName      string `json:"pod_name"`
+	Method       string `json:"method"`
+	Path         string `json:"path"`
+}
+
+// WsStatsDelta는 직전 tick 대비 변경분만 담은 메시지다. Type은 항상 "stats_delta".
+// 클라이언트는 changed를 upsert, removed를 delete로 적용한다.
+type WsStatsDelta struct {
+	Type      string                    `json:"type"`       // "stats_delta"
+	WindowSec int                       `json:"window_sec"` // 집계 윈도우 (초)
+	Changed   []aggregator.EndpointStat `json:"changed"`
+	Removed   []WsStatKey               `json:"removed,omitempty"`
+}
+
+// subscribeMsg는 클라이언트가 보내는 범위 지정 메시지다.
+type subscribeMsg struct {
+	Type      string `json:"type"` // "subscribe"
+	Namespace string `json:"namespace"`
+	Workload  string `json:"workload"`
+	Protocol  uint32 `json:"protocol"`
+}
+
+// clientFilter는 클라이언트별 구독 범위다. 빈 필드는 전체를 뜻한다.
+type clientFilter struct {
+	namespace string
+	workload  string
+	protocol  uint32
+}
+
+func (f *clientFilter) matchEvent(ev *nefiv1.TraceEvent) bool {
+	if f.namespace != "" && ev.Namespace != f.namespace {
+		return false
+	}
+	if f.workload != "" && aggregator.WorkloadName(ev.PodName) != f.workload {
+		return false
+	}
+	if f.protocol != 0 && ev.Protocol != f.protocol {
+		return false
+	}
+	return true
+}
+
+// matchStat — 집계 통계에는 protocol 차원이 없으므로 namespace/workload만 본다.
+func (f *clientFilter) matchStat(st *aggregator.EndpointStat) bool {
+	if f.namespace != "" && st.Namespace != f.namespace {
+		return false
+	}
+	if f.workload != "" && st.WorkloadName != f.workload {
+		return false
+	}
+	return true
+}
+
+func (f *clientFilter) matchKey(k *WsStatKey) bool {
+	if f.namespace != "" && k.Namespace != f.namespace {
+		return false
+	}
+	if f.workload != "" && k.WorkloadName != f.workload {
+		return false
+	}
+	return true
+}
+
 // Hub는 Store와 Aggregator를 구독하고 WebSocket 클라이언트에게 이벤트/통계를 broadcast한다.
 type Hub struct {
 	store   store.Store
@@ -76,11 +169,20 @@ type Hub struct {
 	clients map[*client]struct{}
 	mu      sync.Mutex
 	done    chan struct{}
+
+	// stats delta 상태 — run 고루틴만 접근한다.
+	lastStats map[aggregator.EndpointKey]aggregator.EndpointStat
+	statsTick int
 }
 
 type client struct {
-	conn *websocket.Conn
-	send chan []byte
+	conn   *websocket.Conn
+	send   chan *websocket.PreparedMessage
+	binary bool // event 메시지를 binary 프레임으로 수신
+
+	// filter는 readPump(쓰기)와 broadcast 루프(읽기)가 공유한다.
+	// nil이면 전체 구독.
+	filter atomic.Pointer[clientFilter]
 }
 
 // New는 Hub를 생성하고 Store/Aggregator 구독을 시작한다.
@@ -92,6 +194,8 @@ func New(s store.Store, agg *aggregator.Aggregator) *Hub {
 		aggSub:  agg.Subscribe(),
 		clients: make(map[*client]struct{}),
 		done:    make(chan struct{}),
+
+		lastStats: make(map[aggregator.EndpointKey]aggregator.EndpointStat),
 	}
 	go h.run()
 	return h
@@ -106,15 +210,26 @@ func (h *Hub) ServeHTTP(w http.ResponseWriter, r *http.Request) {
 		return
 	}
 
-	c := &client{conn: conn, send: make(chan []byte, 256)}
+	c := &client{
+		conn:   conn,
+		send:   make(chan *websocket.PreparedMessage, 256),
+		binary: conn.Subprotocol() == binaryProtocol,
+	}
 	h.mu.Lock()
 	h.clients[c] = struct{}{}
 	h.mu.Unlock()
 
 	// 히스토리 먼저 전송
 	for _, ev := range h.store.Recent(historySize) {
-		if data, err := marshalEvent(ev); err == nil {
-			c.send <- data
+		if pm, err := prepareEvent(ev, c.binary); err == nil {
+			c.send <- pm
+		}
+	}
+
+	// delta 스트림의 기준점이 될 stats keyframe 전송
+	if data, err := marshalStats(h.agg.Snapshot(aggregator.DefaultWindowSec)); err == nil {
+		if pm, err := websocket.NewPreparedMessage(websocket.TextMessage, data); err == nil {
+			c.send <- pm
 		}
 	}
 
@@ -144,29 +259,168 @@ func (h *Hub) run() {
 			if !ok {
 				return
 			}
-			data, err := marshalEvent(ev)
-			if err != nil {
-				continue
-			}
-			h.broadcast(data)
+			h.broadcastEvent(ev)
 		case stats, ok := <-h.aggSub:
 			if !ok {
 				return
 			}
-			data, err := marshalStats(stats)
-			if err != nil {
+			h.broadcastStats(stats)
+		}
+	}
+}
+
+// broadcastStats는 직전 tick 대비 변경된 endpoint만 delta로 보내고,
+// keyframeEvery tick마다 전체 스냅샷을 보낸다. 필터 없는 클라이언트는
+// 한 번 marshal한 PreparedMessage를 공유하고, 필터를 건 클라이언트는
+// 직렬화 전에 서버에서 걸러낸 자기 몫만 받는다.
+func (h *Hub) broadcastStats(stats []aggregator.EndpointStat) {
+	h.statsTick++
+	keyframe := h.statsTick%keyframeEvery == 1
+
+	// 변경분 계산 (EndpointStat은 comparable — 필드 단위 비교)
+	cur := make(map[aggregator.EndpointKey]aggregator.EndpointStat, len(stats))
+	var changed []aggregator.EndpointStat
+	for _, st := range stats {
+		key := aggregator.EndpointKey{
+			Namespace: st.Namespace, PodName: st.PodName,
+			Method: st.Method, Path: st.Path,
+		}
+		cur[key] = st
+		if prev, ok := h.lastStats[key]; !ok || prev != st {
+			changed = append(changed, st)
+		}
+	}
+	var removed []WsStatKey
+	for key, prev := range h.lastStats {
+		if _, ok := cur[key]; !ok {
+			removed = append(removed, WsStatKey{
+				Namespace: key.Namespace, WorkloadName: prev.WorkloadName,
+				PodName: key.PodName, Method: key.Method, Path: key.Path,
+			})
+		}
+	}
+	h.lastStats = cur
+
+	if !keyframe && len(changed) == 0 && len(removed) == 0 {
+		return // 변화 없음 — 1Hz 재전송 생략
+	}
+
+	var sharedPM *websocket.PreparedMessage // 필터 없는 클라이언트용 (lazy)
+	h.mu.Lock()
+	for c := range h.clients {
+		f := c.filter.Load()
+		var pm *websocket.PreparedMessage
+		if f == nil {
+			if sharedPM == nil {
+				data, err := marshalStatsMsg(keyframe, stats, changed, removed, nil)
+				if err != nil || data == nil {
+					break // 전 클라이언트 공통 — 만들 수 없으면 tick 생략
+				}
+				if sharedPM, err = websocket.NewPreparedMessage(websocket.TextMessage, data); err != nil {
+					break
+				}
+			}
+			pm = sharedPM
+		} else {
+			data, err := marshalStatsMsg(keyframe, stats, changed, removed, f)
+			if err != nil || data == nil {
+				continue // 이 클라이언트 범위에는 변화 없음
+			}
+			var perr error
+			if pm, perr = websocket.NewPreparedMessage(websocket.TextMessage, data); perr != nil {
 				continue
 			}
-			h.broadcast(data)
+		}
+		select {
+		case c.send <- pm:
+		default:
+			// 클라이언트가 느리면 drop — 다음 keyframe에서 재동기화된다.
 		}
 	}
+	h.mu.Unlock()
+}
+
+// marshalStatsMsg는 keyframe이면 전체 스냅샷("stats"), 아니면 변경분만
+// ("stats_delta")을 f 범위로 걸러 marshal한다. delta에 보낼 것이 없으면
+// (nil, nil)을 반환한다.
+func marshalStatsMsg(keyframe bool, stats, changed []aggregator.EndpointStat, removed []WsStatKey, f *clientFilter) ([]byte, error) {
+	if keyframe {
+		return marshalStats(filterStats(stats, f))
+	}
+	ch := filterStats(changed, f)
+	rm := removed
+	if f != nil {
+		rm = nil
+		for i := range removed {
+			if f.matchKey(&removed[i]) {
+				rm = append(rm, removed[i])
+			}
+		}
+	}
+	if len(ch) == 0 && len(rm) == 0 {
+		return nil, nil
+	}
+	return json.Marshal(WsStatsDelta{
+		Type:      "stats_delta",
+		WindowSec: aggregator.DefaultWindowSec,
+		Changed:   ch,
+		Removed:   rm,
+	})
+}
+
+func filterStats(stats []aggregator.EndpointStat, f *clientFilter) []aggregator.EndpointStat {
+	if f == nil {
+		return stats
+	}
+	var out []aggregator.EndpointStat
+	for i := range stats {
+		if f.matchStat(&stats[i]) {
+			out = append(out, stats[i])
+		}
+	}
+	return out
 }
 
-func (h *Hub) broadcast(data []byte) {
+// broadcastEvent는 접속 중인 클라이언트 구성에 따라 JSON/binary 프레임을
+// 각각 최대 한 번씩만 준비해 공유한다 — 포맷당 marshal+프레이밍 1회.
+func (h *Hub) broadcastEvent(ev *nefiv1.TraceEvent) {
+	var jsonPM, binPM *websocket.PreparedMessage
 	h.mu.Lock()
 	for c := range h.clients {
+		if f := c.filter.Load(); f != nil && !f.matchEvent(ev) {
+			continue // 구독 범위 밖 — 직렬화 비용도 들이지 않는다
+		}
+		var pm *websocket.PreparedMessage
+		var err error
+		if c.binary {
+			if binPM == nil {
+				if binPM, err = prepareEvent(ev, true); err != nil {
+					continue
+				}
+			}
+			pm = binPM
+		} else {
+			if jsonPM == nil {
+				if jsonPM, err = prepareEvent(ev, false); err != nil {
+					continue
+				}
+			}
+			pm = jsonPM
+		}
 		select {
-		case c.send <- data:
+		case c.send <- pm:
+		default:
+			// 클라이언트가 느리면 drop
+		}
+	}
+	h.mu.Unlock()
+}
+
+func (h *Hub) broadcast(pm *websocket.PreparedMessage) {
+	h.mu.Lock()
+	for c := range h.clients {
+		select {
+		case c.send <- pm:
 		default:
 			// 클라이언트가 느리면 drop
 		}
@@ -188,7 +442,8 @@ func (c *client) writePump() {
 				c.conn.WriteMessage(websocket.CloseMessage, []byte{})
 				return
 			}
-			if err := c.conn.WriteMessage(websocket.TextMessage, msg); err != nil {
+			// PreparedMessage는 프레이밍된 바이트를 클라이언트 간에 공유한다.
+			if err := c.conn.WritePreparedMessage(msg); err != nil {
 				return
 			}
 		case <-ticker.C:
@@ -212,10 +467,30 @@ func (c *client) readPump(onClose func()) {
 		return nil
 	})
 	for {
-		if _, _, err := c.conn.ReadMessage(); err != nil {
+		_, data, err := c.conn.ReadMessage()
+		if err != nil {
 			break
 		}
+		c.handleMessage(data)
+	}
+}
+
+// handleMessage는 클라이언트가 보낸 제어 메시지를 처리한다.
+// 현재는 subscribe뿐이며 알 수 없는 메시지는 무시한다.
+func (c *client) handleMessage(data []byte) {
+	var msg subscribeMsg
+	if json.Unmarshal(data, &msg) != nil || msg.Type != "subscribe" {
+		return
+	}
+	if msg.Namespace == "" && msg.Workload == "" && msg.Protocol == 0 {
+		c.filter.Store(nil) // 빈 subscribe = 필터 해제
+		return
 	}
+	c.filter.Store(&clientFilter{
+		namespace: msg.Namespace,
+		workload:  msg.Workload,
+		protocol:  msg.Protocol,
+	})
 }
 
 func marshalStats(stats []aggregator.EndpointStat) ([]byte, error) {
@@ -253,6 +528,70 @@ func marshalEvent(ev *nefiv1.TraceEvent) ([]byte, error) {
 	return json.Marshal(ws)
 }
 
+// prepareEvent는 event 메시지를 한 번만 직렬화한 PreparedMessage로 만든다.
+func prepareEvent(ev *nefiv1.TraceEvent, binaryFrame bool) (*websocket.PreparedMessage, error) {
+	if binaryFrame {
+		return websocket.NewPreparedMessage(websocket.BinaryMessage, encodeBinaryEvent(ev))
+	}
+	data, err := marshalEvent(ev)
+	if err != nil {
+		return nil, err
+	}
+	return websocket.NewPreparedMessage(websocket.TextMessage, data)
+}
+
+// ─── binary event 프레임 (subprotocol "nefi.bin.v1") ────────────
+//
+// little-endian 고정 레이아웃:
+//
+//	u8  version (=1)
+//	u64 timestamp_ns
+//	u32 pid | u32 fd | u32 msg_size
+//	u8  direction | u8 protocol | u8 msg_type
+//	u32 remote_ip | u16 remote_port
+//	i16 http_status
+//	이후 u16 길이 prefix 문자열 10개 (순서 고정):
+//	  comm, namespace, pod_name, node_name, remote_ns, remote_pod,
+//	  http_method, http_path, http_content_type, payload(printable ASCII)
+//
+// JSON 대비 필드 이름/이스케이프 오버헤드가 없고 marshal이 단일 append
+// 패스다. 레이아웃 변경 시 version을 올리고 새 subprotocol을 추가한다.
+
+const binaryFrameVersion = 1
+
+func encodeBinaryEvent(ev *nefiv1.TraceEvent) []byte {
+	payload := toPrintable(ev.Payload)
+	strs := [...]string{
+		ev.Comm, ev.Namespace, ev.PodName, ev.NodeName,
+		ev.RemoteNs, ev.RemotePod,
+		ev.HttpMethod, ev.HttpPath, ev.HttpContentType, payload,
+	}
+
+	size := 1 + 8 + 4*3 + 3 + 4 + 2 + 2
+	for _, s := range strs {
+		size += 2 + len(s)
+	}
+
+	buf := make([]byte, 0, size)
+	buf = append(buf, binaryFrameVersion)
+	buf = binary.LittleEndian.AppendUint64(buf, ev.TimestampNs)
+	buf = binary.LittleEndian.AppendUint32(buf, ev.Pid)
+	buf = binary.LittleEndian.AppendUint32(buf, ev.Fd)
+	buf = binary.LittleEndian.AppendUint32(buf, ev.MsgSize)
+	buf = append(buf, byte(ev.Direction), byte(ev.Protocol), byte(ev.MsgType))
+	buf = binary.LittleEndian.AppendUint32(buf, ev.RemoteIp)
+	buf = binary.LittleEndian.AppendUint16(buf, uint16(ev.RemotePort))
+	buf = binary.LittleEndian.AppendUint16(buf, uint16(ev.HttpStatus))
+	for _, s := range strs {
+		if len(s) > 0xffff {
+			s = s[:0xffff]
+		}
+		buf = binary.LittleEndian.AppendUint16(buf, uint16(len(s)))
+		buf = append(buf, s...)
+	}
+	return buf
+}
+
 // toPrintable는 바이너리 페이로드를 출력 가능한 ASCII 문자열로 변환한다.
 func toPrintable(b []byte) string {
 	if len(b) == 0 {
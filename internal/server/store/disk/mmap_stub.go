@@ -0,0 +1,17 @@
+//go:build !unix
+
+package disk
+
+import (
+	"io"
+	"os"
+)
+
+// mmapFile 폴백 — mmap이 없는 플랫폼에서는 파일을 통째로 읽는다.
+func mmapFile(f *os.File, size int64) ([]byte, func(), error) {
+	data := make([]byte, size)
+	if _, err := f.ReadAt(data, 0); err != nil && err != io.EOF {
+		return nil, nil, err
+	}
+	return data, func() {}, nil
+}
@@ -0,0 +1,22 @@
+//go:build unix
+
+package disk
+
+import (
+	"os"
+	"syscall"
+)
+
+// mmapFile은 파일 전체를 read-only로 매핑한다. 반환된 해제 함수를 반드시
+// 호출해야 한다. 세그먼트 스캔이 page cache를 직접 읽으므로 레코드 복사
+// 버퍼가 필요 없다.
+func mmapFile(f *os.File, size int64) ([]byte, func(), error) {
+	if size == 0 {
+		return nil, func() {}, nil
+	}
+	data, err := syscall.Mmap(int(f.Fd()), 0, int(size), syscall.PROT_READ, syscall.MAP_SHARED)
+	if err != nil {
+		return nil, nil, err
+	}
+	return data, func() { _ = syscall.Munmap(data) }, nil
+}
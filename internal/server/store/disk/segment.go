@@ -0,0 +1,172 @@
+package disk
+
+import (
+	"bufio"
+	"encoding/binary"
+	"fmt"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"time"
+)
+
+// ─── 세그먼트 파일 포맷 ─────────────────────────────────────────
+//
+//	header (32B): magic "NEFISEG1" | firstTsNs u64 | lastTsNs u64 | count u64
+//	records:      u32 length | proto(TraceEvent)  (반복, little-endian)
+//
+// header의 시간 범위는 seal 시점에 기록된다 — 쓰는 중인(active) 세그먼트는
+// header가 0이며, 읽기 쪽은 이를 "범위 미상, 전체 스캔"으로 취급한다.
+// 프로세스가 비정상 종료해도 앞쪽의 온전한 레코드는 모두 읽을 수 있고,
+// 잘린 꼬리 레코드는 스캔이 조용히 무시한다.
+
+const (
+	segMagic      = "NEFISEG1"
+	segHeaderSize = 32
+	segSuffix     = ".seg"
+
+	// maxRecordSize는 손상된 length 필드로 인한 과할당을 막는 상한이다.
+	maxRecordSize = 1 << 20
+)
+
+type segHeader struct {
+	firstTsNs uint64
+	lastTsNs  uint64
+	count     uint64
+}
+
+// sealed는 header가 기록됐는지 (seal을 거쳤는지) 여부다.
+func (h *segHeader) sealed() bool { return h.count > 0 }
+
+// overlaps는 [fromNs, toNs] 범위와 겹치는지 확인한다.
+// seal 전 세그먼트는 범위를 모르므로 항상 겹친다고 본다.
+func (h *segHeader) overlaps(fromNs, toNs uint64) bool {
+	if !h.sealed() {
+		return true
+	}
+	return h.lastTsNs >= fromNs && h.firstTsNs <= toNs
+}
+
+func encodeHeader(h segHeader) [segHeaderSize]byte {
+	var buf [segHeaderSize]byte
+	copy(buf[:8], segMagic)
+	binary.LittleEndian.PutUint64(buf[8:], h.firstTsNs)
+	binary.LittleEndian.PutUint64(buf[16:], h.lastTsNs)
+	binary.LittleEndian.PutUint64(buf[24:], h.count)
+	return buf
+}
+
+func decodeHeader(data []byte) (segHeader, bool) {
+	if len(data) < segHeaderSize || string(data[:8]) != segMagic {
+		return segHeader{}, false
+	}
+	return segHeader{
+		firstTsNs: binary.LittleEndian.Uint64(data[8:]),
+		lastTsNs:  binary.LittleEndian.Uint64(data[16:]),
+		count:     binary.LittleEndian.Uint64(data[24:]),
+	}, true
+}
+
+// scanRecords는 세그먼트 바이트에서 레코드 payload를 순회한다.
+// fn이 false를 반환하거나 잘린/손상된 레코드를 만나면 중단한다.
+func scanRecords(data []byte, fn func(rec []byte) bool) {
+	off := segHeaderSize
+	for off+4 <= len(data) {
+		n := int(binary.LittleEndian.Uint32(data[off:]))
+		if n == 0 || n > maxRecordSize || off+4+n > len(data) {
+			return // 잘린 꼬리 또는 손상
+		}
+		if !fn(data[off+4 : off+4+n]) {
+			return
+		}
+		off += 4 + n
+	}
+}
+
+// ─── writer ─────────────────────────────────────────────────────
+
+// segmentWriter는 active 세그먼트 하나에 레코드를 append한다.
+// 동시성 제어는 호출자(Store.mu) 몫이다.
+type segmentWriter struct {
+	f      *os.File
+	bw     *bufio.Writer
+	path   string
+	size   int64
+	hdr    segHeader
+	lenBuf [4]byte
+}
+
+// newSegmentWriter는 생성 시각을 이름으로 하는 새 세그먼트를 연다.
+// 자리만 잡은 zero header를 먼저 쓰고 seal 때 채운다.
+func newSegmentWriter(dir string) (*segmentWriter, error) {
+	path := filepath.Join(dir, fmt.Sprintf("%020d%s", time.Now().UnixNano(), segSuffix))
+	f, err := os.OpenFile(path, os.O_CREATE|os.O_WRONLY|os.O_EXCL, 0o644)
+	if err != nil {
+		return nil, fmt.Errorf("create segment: %w", err)
+	}
+	w := &segmentWriter{f: f, bw: bufio.NewWriter(f), path: path, size: segHeaderSize}
+	var zero [segHeaderSize]byte
+	copy(zero[:8], segMagic)
+	if _, err := w.bw.Write(zero[:]); err != nil {
+		f.Close()
+		return nil, fmt.Errorf("write segment header: %w", err)
+	}
+	return w, nil
+}
+
+func (w *segmentWriter) append(rec []byte, tsNs uint64) error {
+	binary.LittleEndian.PutUint32(w.lenBuf[:], uint32(len(rec)))
+	if _, err := w.bw.Write(w.lenBuf[:]); err != nil {
+		return err
+	}
+	if _, err := w.bw.Write(rec); err != nil {
+		return err
+	}
+	w.size += int64(4 + len(rec))
+	if w.hdr.count == 0 || tsNs < w.hdr.firstTsNs {
+		w.hdr.firstTsNs = tsNs
+	}
+	if tsNs > w.hdr.lastTsNs {
+		w.hdr.lastTsNs = tsNs
+	}
+	w.hdr.count++
+	return nil
+}
+
+func (w *segmentWriter) flush() error { return w.bw.Flush() }
+
+// seal은 버퍼를 비우고 header에 시간 범위를 기록한 뒤 파일을 닫는다.
+func (w *segmentWriter) seal() error {
+	if err := w.bw.Flush(); err != nil {
+		w.f.Close()
+		return err
+	}
+	hdr := encodeHeader(w.hdr)
+	if _, err := w.f.WriteAt(hdr[:], 0); err != nil {
+		w.f.Close()
+		return err
+	}
+	if err := w.f.Sync(); err != nil {
+		w.f.Close()
+		return err
+	}
+	return w.f.Close()
+}
+
+// listSegments는 dir의 세그먼트 경로를 오래된 것부터 정렬해 반환한다.
+// (파일 이름이 생성 시각이므로 이름 정렬 = 시간 정렬)
+func listSegments(dir string) ([]string, error) {
+	entries, err := os.ReadDir(dir)
+	if err != nil {
+		return nil, err
+	}
+	var paths []string
+	for _, e := range entries {
+		if !e.IsDir() && strings.HasSuffix(e.Name(), segSuffix) {
+			paths = append(paths, filepath.Join(dir, e.Name()))
+		}
+	}
+	sort.Strings(paths)
+	return paths, nil
+}
@@ -0,0 +1,391 @@
+// Package disk는 append-only 세그먼트 파일 기반의 영속 Store 구현이다.
+//
+// 계층 구조:
+//   - 쓰기: 모든 이벤트가 인메모리 hot tier(memory.Store)와 디스크 세그먼트
+//     양쪽에 기록된다(write-through). 실시간 조회(Recent/Query/Subscribe)는
+//     전부 hot tier가 처리하므로 디스크가 hot path를 느리게 하지 않는다.
+//   - 읽기: QueryRange가 세그먼트 header의 시간 범위로 후보를 거른 뒤
+//     해당 파일만 mmap으로 스캔한다 — RAM 용량(초 단위)이 아니라 디스크
+//     용량(시간 단위)만큼의 히스토리를 조회할 수 있다.
+//   - 보존: 세그먼트가 maxSegmentBytes에 도달하면 seal 후 교체되고,
+//     총량/나이 기반 retention 루프가 오래된 세그먼트를 지운다.
+//   - 재시작: 기동 시 최신 세그먼트에서 hot tier 용량만큼 replay해
+//     nefi-server 재배포 직후에도 대시보드가 비지 않는다.
+package disk
+
+import (
+	"fmt"
+	"log"
+	"os"
+	"sync"
+	"time"
+
+	"google.golang.org/protobuf/proto"
+
+	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
+	"github.com/gihongjo/nefi/internal/server/store/memory"
+)
+
+const (
+	maxSegmentBytes = 64 << 20 // seal 후 새 세그먼트로 교체하는 크기
+	maxTotalBytes   = 1 << 30  // sealed 세그먼트 총량 상한 (초과분은 오래된 것부터 삭제)
+	maxSegmentAge   = 24 * time.Hour
+
+	flushInterval     = time.Second // active 세그먼트 버퍼 플러시 주기
+	retentionInterval = time.Minute
+)
+
+// Store는 memory.Store를 hot tier로 쓰는 write-through 영속 저장소다.
+type Store struct {
+	hot *memory.Store
+	dir string
+
+	mu sync.Mutex // active 세그먼트 writer 보호
+	w  *segmentWriter
+
+	stopCh    chan struct{}
+	closeOnce sync.Once
+}
+
+// New는 dir 아래의 세그먼트로 영속 Store를 연다.
+// 기존 세그먼트가 있으면 최신 이벤트를 hotCapacity만큼 hot tier에 복원한다.
+func New(dir string, hotCapacity int) (*Store, error) {
+	if err := os.MkdirAll(dir, 0o755); err != nil {
+		return nil, fmt.Errorf("create data dir %s: %w", dir, err)
+	}
+
+	s := &Store{
+		hot:    memory.New(hotCapacity),
+		dir:    dir,
+		stopCh: make(chan struct{}),
+	}
+
+	if err := s.warmStart(hotCapacity); err != nil {
+		// 복원 실패는 치명적이지 않다 — 빈 hot tier로 계속한다.
+		log.Printf("[store] warm start failed: %v", err)
+	}
+
+	w, err := newSegmentWriter(dir)
+	if err != nil {
+		return nil, err
+	}
+	s.w = w
+
+	go s.flushLoop()
+	go s.retentionLoop()
+	return s, nil
+}
+
+// ─── 쓰기 경로 ──────────────────────────────────────────────────
+
+// Add는 hot tier에 저장한 뒤 디스크에 append한다.
+func (s *Store) Add(event *nefiv1.TraceEvent) {
+	s.hot.Add(event)
+	s.mu.Lock()
+	s.appendLocked(event)
+	s.mu.Unlock()
+}
+
+// AddBatch는 배치 전체를 한 번의 락으로 디스크에 append한다.
+func (s *Store) AddBatch(events []*nefiv1.TraceEvent) {
+	s.hot.AddBatch(events)
+	s.mu.Lock()
+	for _, event := range events {
+		s.appendLocked(event)
+	}
+	s.mu.Unlock()
+}
+
+// appendLocked는 이벤트를 active 세그먼트에 쓰고 필요하면 rotate한다.
+// 디스크 오류는 로그만 남긴다 — 영속화 실패가 실시간 경로를 막지 않는다.
+func (s *Store) appendLocked(event *nefiv1.TraceEvent) {
+	if s.w == nil {
+		return
+	}
+	rec, err := proto.Marshal(event)
+	if err != nil {
+		log.Printf("[store] marshal event: %v", err)
+		return
+	}
+	if err := s.w.append(rec, event.TimestampNs); err != nil {
+		log.Printf("[store] segment append: %v", err)
+		return
+	}
+	if s.w.size >= maxSegmentBytes {
+		s.rotateLocked()
+	}
+}
+
+func (s *Store) rotateLocked() {
+	if err := s.w.seal(); err != nil {
+		log.Printf("[store] segment seal: %v", err)
+	}
+	w, err := newSegmentWriter(s.dir)
+	if err != nil {
+		log.Printf("[store] segment rotate: %v", err)
+		s.w = nil // 다음 rotate 주기까지 디스크 기록 중단
+		return
+	}
+	s.w = w
+}
+
+// ─── 실시간 조회 (hot tier 위임) ────────────────────────────────
+
+func (s *Store) Subscribe() <-chan *nefiv1.TraceEvent     { return s.hot.Subscribe() }
+func (s *Store) Unsubscribe(ch <-chan *nefiv1.TraceEvent) { s.hot.Unsubscribe(ch) }
+func (s *Store) Recent(n int) []*nefiv1.TraceEvent        { return s.hot.Recent(n) }
+func (s *Store) Query(f memory.Filter, limit int) []*nefiv1.TraceEvent {
+	return s.hot.Query(f, limit)
+}
+
+// ─── 히스토리 조회 ──────────────────────────────────────────────
+
+// QueryRange는 [fromNs, toNs] 시간 범위(wall clock UnixNano)의 이벤트를 filter로 걸러 최대
+// limit개, 오래된 것부터 반환한다. toNs가 0이면 상한 없음이다.
+// header 시간 범위가 겹치는 세그먼트만 mmap으로 스캔한다.
+func (s *Store) QueryRange(fromNs, toNs uint64, f memory.Filter, limit int) ([]*nefiv1.TraceEvent, error) {
+	if toNs == 0 {
+		toNs = ^uint64(0)
+	}
+	if limit <= 0 {
+		return []*nefiv1.TraceEvent{}, nil
+	}
+
+	// active 세그먼트 내용도 보이도록 버퍼를 먼저 비운다.
+	s.mu.Lock()
+	if s.w != nil {
+		if err := s.w.flush(); err != nil {
+			log.Printf("[store] segment flush: %v", err)
+		}
+	}
+	s.mu.Unlock()
+
+	paths, err := listSegments(s.dir)
+	if err != nil {
+		return nil, fmt.Errorf("list segments: %w", err)
+	}
+
+	var result []*nefiv1.TraceEvent
+	for _, path := range paths {
+		if err := s.scanSegment(path, fromNs, toNs, &f, &result, limit); err != nil {
+			log.Printf("[store] scan %s: %v", path, err)
+		}
+	}
+	if len(result) > limit {
+		result = result[len(result)-limit:]
+	}
+	return result, nil
+}
+
+// scanSegment은 세그먼트 하나를 mmap해 범위/필터에 맞는 이벤트를 out에
+// 모은다. out이 limit의 2배를 넘으면 앞(오래된 쪽)을 잘라내므로 최종적으로
+// 최신 limit개가 보존된다.
+func (s *Store) scanSegment(path string, fromNs, toNs uint64, f *memory.Filter, out *[]*nefiv1.TraceEvent, limit int) error {
+	file, err := os.Open(path)
+	if err != nil {
+		return err
+	}
+	defer file.Close()
+	info, err := file.Stat()
+	if err != nil {
+		return err
+	}
+	if info.Size() < segHeaderSize {
+		return nil
+	}
+
+	data, unmap, err := mmapFile(file, info.Size())
+	if err != nil {
+		return err
+	}
+	defer unmap()
+
+	hdr, ok := decodeHeader(data)
+	if !ok {
+		return fmt.Errorf("bad segment header")
+	}
+	if !hdr.overlaps(fromNs, toNs) {
+		return nil
+	}
+
+	scanRecords(data, func(rec []byte) bool {
+		ev := &nefiv1.TraceEvent{}
+		if proto.Unmarshal(rec, ev) != nil {
+			return false // 손상 — 이후 레코드 경계를 신뢰할 수 없다
+		}
+		if ev.TimestampNs < fromNs || ev.TimestampNs > toNs || !f.Match(ev) {
+			return true
+		}
+		*out = append(*out, ev)
+		if len(*out) > 2*limit {
+			*out = (*out)[len(*out)-limit:]
+		}
+		return true
+	})
+	return nil
+}
+
+// ─── 백그라운드 루프 ────────────────────────────────────────────
+
+// flushLoop는 active 세그먼트 버퍼를 주기적으로 디스크에 내린다.
+// 크래시 시 잃는 구간을 flushInterval로 제한한다.
+func (s *Store) flushLoop() {
+	ticker := time.NewTicker(flushInterval)
+	defer ticker.Stop()
+	for {
+		select {
+		case <-s.stopCh:
+			return
+		case <-ticker.C:
+			s.mu.Lock()
+			if s.w != nil {
+				if err := s.w.flush(); err != nil {
+					log.Printf("[store] segment flush: %v", err)
+				}
+			} else {
+				// 이전 rotate 실패 복구 시도
+				s.rotateRecoverLocked()
+			}
+			s.mu.Unlock()
+		}
+	}
+}
+
+func (s *Store) rotateRecoverLocked() {
+	w, err := newSegmentWriter(s.dir)
+	if err != nil {
+		return
+	}
+	s.w = w
+	log.Printf("[store] segment writer recovered")
+}
+
+// retentionLoop는 sealed 세그먼트를 총량/나이 기준으로 정리한다.
+func (s *Store) retentionLoop() {
+	ticker := time.NewTicker(retentionInterval)
+	defer ticker.Stop()
+	for {
+		select {
+		case <-s.stopCh:
+			return
+		case <-ticker.C:
+			s.applyRetention()
+		}
+	}
+}
+
+func (s *Store) applyRetention() {
+	paths, err := listSegments(s.dir)
+	if err != nil {
+		log.Printf("[store] retention list: %v", err)
+		return
+	}
+
+	s.mu.Lock()
+	active := ""
+	if s.w != nil {
+		active = s.w.path
+	}
+	s.mu.Unlock()
+
+	type segInfo struct {
+		path  string
+		size  int64
+		mtime time.Time
+		hdr   segHeader
+	}
+	var segs []segInfo
+	var total int64
+	for _, path := range paths {
+		if path == active {
+			continue
+		}
+		info, err := os.Stat(path)
+		if err != nil {
+			continue
+		}
+		hdr := readSegmentHeader(path)
+		segs = append(segs, segInfo{path: path, size: info.Size(), mtime: info.ModTime(), hdr: hdr})
+		total += info.Size()
+	}
+
+	// 나이 판정은 header의 lastTsNs(agent가 UnixNano로 변환해 보낸 wall
+	// clock)로 하되, 파일 mtime과 교차 확인한다. boot-relative timestamp를
+	// 보내던 구버전 agent가 쓴 세그먼트는 lastTsNs가 항상 cutoff보다 작아
+	// 보이므로, mtime 확인 없이는 첫 retention 주기에 히스토리 전체가
+	// 지워진다.
+	cutoff := time.Now().Add(-maxSegmentAge)
+	cutoffNs := cutoff.UnixNano()
+	for _, seg := range segs { // 오래된 것부터 (listSegments가 이름=시간순 정렬)
+		tooOld := seg.hdr.sealed() && seg.hdr.lastTsNs < uint64(cutoffNs) &&
+			seg.mtime.Before(cutoff)
+		if total <= maxTotalBytes && !tooOld {
+			break
+		}
+		if err := os.Remove(seg.path); err != nil {
+			log.Printf("[store] retention remove %s: %v", seg.path, err)
+			continue
+		}
+		total -= seg.size
+	}
+}
+
+// readSegmentHeader는 파일 앞 32바이트만 읽어 header를 반환한다.
+func readSegmentHeader(path string) segHeader {
+	f, err := os.Open(path)
+	if err != nil {
+		return segHeader{}
+	}
+	defer f.Close()
+	var buf [segHeaderSize]byte
+	if _, err := f.ReadAt(buf[:], 0); err != nil {
+		return segHeader{}
+	}
+	hdr, _ := decodeHeader(buf[:])
+	return hdr
+}
+
+// ─── 재시작 복원 ────────────────────────────────────────────────
+
+// warmStart는 최신 세그먼트부터 거꾸로 읽어 hot tier 용량만큼의 최근
+// 이벤트를 복원한다. 구독자가 붙기 전(New 내부)에만 호출된다.
+func (s *Store) warmStart(capacity int) error {
+	paths, err := listSegments(s.dir)
+	if err != nil {
+		return err
+	}
+
+	var restored []*nefiv1.TraceEvent
+	for i := len(paths) - 1; i >= 0 && len(restored) < capacity; i-- {
+		var segEvents []*nefiv1.TraceEvent
+		if err := s.scanSegment(paths[i], 0, ^uint64(0), &memory.Filter{}, &segEvents, capacity); err != nil {
+			log.Printf("[store] warm start scan %s: %v", paths[i], err)
+			continue
+		}
+		restored = append(segEvents, restored...)
+	}
+	if len(restored) > capacity {
+		restored = restored[len(restored)-capacity:]
+	}
+	if len(restored) > 0 {
+		s.hot.AddBatch(restored)
+		log.Printf("[store] restored %d events from %s", len(restored), s.dir)
+	}
+	return nil
+}
+
+// Close는 백그라운드 루프를 멈추고 active 세그먼트를 seal한다.
+func (s *Store) Close() {
+	s.closeOnce.Do(func() {
+		close(s.stopCh)
+		s.mu.Lock()
+		if s.w != nil {
+			if err := s.w.seal(); err != nil {
+				log.Printf("[store] final seal: %v", err)
+			}
+			s.w = nil
+		}
+		s.mu.Unlock()
+		s.hot.Close()
+	})
+}
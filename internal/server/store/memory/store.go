@@ -1,62 +1,327 @@
 // Package memory는 인메모리 ring buffer 기반 Store 구현이다.
 //
 // 동작 방식:
-//   - Add: ring buffer에 이벤트 저장 + 모든 구독자 채널에 비블로킹 전송
-//   - ring buffer가 가득 차면 가장 오래된 이벤트를 덮어씀
-//   - 구독자 채널이 느리면 이벤트를 drop (backpressure 없음)
+//   - 이벤트는 pod 이름 해시(없으면 PID)로 numShards개 shard에 분산된다.
+//     collector worker들이 서로 다른 shard를 병렬로 쓰므로 단일 락 경합이
+//     없다. shard마다 독립된 ring buffer가 있고 가득 차면 가장 오래된
+//     이벤트를 덮어쓴다.
+//   - shard는 namespace/pod/protocol/status-class 보조 인덱스(seq posting
+//     list)를 유지한다. Query는 가장 선택적인 인덱스의 posting list만
+//     역순으로 걷기 때문에 드릴다운 요청이 ring 전체를 스캔하지 않는다.
+//   - 구독자 목록은 copy-on-write 슬라이스다 — Add 경로는 atomic load만
+//     하고 락도 복사도 없다. 구독자 채널이 느리면 이벤트를 drop한다
+//     (backpressure 없음).
 package memory
 
 import (
+	"sort"
 	"sync"
+	"sync/atomic"
 
 	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
 )
 
-const subscriberChanSize = 256
+const (
+	subscriberChanSize = 256
 
-// Store는 인메모리 ring buffer + 구독자 맵으로 구성된다.
+	// numShards는 2의 거듭제곱이어야 한다.
+	numShards = 8
+)
+
+// Filter는 Query의 선택 조건이다. zero value 필드는 "무관"을 뜻한다.
+// (store.Filter로 재노출된다 — 인터페이스 패키지가 이 패키지를 import하는
+// 방향이므로 정의는 여기에 둔다.)
+type Filter struct {
+	Namespace   string
+	PodName     string
+	Protocol    uint32 // 0 = any
+	StatusClass int32  // 0 = any; 2/3/4/5 = 2xx/3xx/4xx/5xx
+}
+
+// Match는 이벤트가 필터 조건을 모두 만족하는지 확인한다.
+// (disk 계층의 range 스캔도 같은 필터 의미를 쓰도록 export한다.)
+func (f *Filter) Match(ev *nefiv1.TraceEvent) bool {
+	if f.Namespace != "" && ev.Namespace != f.Namespace {
+		return false
+	}
+	if f.PodName != "" && ev.PodName != f.PodName {
+		return false
+	}
+	if f.Protocol != 0 && ev.Protocol != f.Protocol {
+		return false
+	}
+	if f.StatusClass != 0 && ev.HttpStatus/100 != f.StatusClass {
+		return false
+	}
+	return true
+}
+
+// shard는 독립된 ring buffer + 보조 인덱스 한 벌이다.
+//
+// 인덱스는 키 → 오름차순 seq posting list다. ring이 덮어쓴(seq < minSeq)
+// 항목은 추가 시점에 posting list 앞에서 잘라내고, 조회 시점에도 걸러진다.
+// 덮어쓰기로 쫓겨난 이벤트의 키는 그 자리에서 다시 다듬어 빈 리스트의
+// 키를 맵에서 지운다 — 인덱스 크기는 항상 ring에 살아 있는 키로 한정된다.
+type shard struct {
+	mu       sync.RWMutex
+	ring     []*nefiv1.TraceEvent
+	capacity int
+	seq      uint64 // 지금까지 추가된 이벤트 수; seq-1이 최신 이벤트의 번호
+	count    int    // 저장된 이벤트 수 (최대 capacity)
+
+	byNamespace   map[string][]uint64
+	byPod         map[string][]uint64
+	byProtocol    map[uint32][]uint64
+	byStatusClass map[int32][]uint64
+}
+
+func newShard(capacity int) *shard {
+	return &shard{
+		ring:          make([]*nefiv1.TraceEvent, capacity),
+		capacity:      capacity,
+		byNamespace:   make(map[string][]uint64),
+		byPod:         make(map[string][]uint64),
+		byProtocol:    make(map[uint32][]uint64),
+		byStatusClass: make(map[int32][]uint64),
+	}
+}
+
+// minSeq는 아직 ring에 살아 있는 가장 오래된 seq다. 호출자가 락을 잡는다.
+func (s *shard) minSeq() uint64 {
+	return s.seq - uint64(s.count)
+}
+
+// appendSeq는 posting list에 seq를 추가하면서 덮어쓰인 앞부분을 잘라낸다.
+// 앞부분 절단은 슬라이스 재참조라 O(1)이고, 버려진 prefix 메모리는 다음
+// append 재할당 때 회수된다.
+func appendSeq(list []uint64, seq, minSeq uint64) []uint64 {
+	i := 0
+	for i < len(list) && list[i] < minSeq {
+		i++
+	}
+	return append(list[i:], seq)
+}
+
+// trimIndex는 posting list에서 덮어쓰인(seq < min) prefix를 잘라내고,
+// 남는 항목이 없으면 맵에서 키를 지운다. appendSeq는 같은 키에 새 이벤트가
+// 올 때만 다듬으므로, 다시는 이벤트가 오지 않는 키(삭제된 pod/namespace)는
+// 이 경로로만 정리된다. 호출자가 mu를 잡는다.
+func trimIndex[K comparable](idx map[K][]uint64, key K, min uint64) {
+	list := idx[key]
+	i := 0
+	for i < len(list) && list[i] < min {
+		i++
+	}
+	if i == len(list) {
+		delete(idx, key)
+		return
+	}
+	if i > 0 {
+		idx[key] = list[i:]
+	}
+}
+
+// add는 이벤트를 ring과 인덱스에 기록한다. 호출자가 mu를 잡는다.
+func (s *shard) add(event *nefiv1.TraceEvent) {
+	// ring이 가득 차면 덮어쓰는 자리의 이벤트를 기억해 뒀다가, 그 키의
+	// posting list를 정리한다 — pod churn으로 다시는 이벤트가 오지 않는
+	// 키가 stale posting list를 들고 무한히 쌓이는 것을 막는다.
+	var evicted *nefiv1.TraceEvent
+	if s.count == s.capacity {
+		evicted = s.ring[s.seq%uint64(s.capacity)]
+	}
+
+	s.ring[s.seq%uint64(s.capacity)] = event
+	s.seq++
+	if s.count < s.capacity {
+		s.count++
+	}
+
+	seq := s.seq - 1
+	min := s.minSeq()
+	if event.Namespace != "" {
+		s.byNamespace[event.Namespace] = appendSeq(s.byNamespace[event.Namespace], seq, min)
+	}
+	if event.PodName != "" {
+		s.byPod[event.PodName] = appendSeq(s.byPod[event.PodName], seq, min)
+	}
+	s.byProtocol[event.Protocol] = appendSeq(s.byProtocol[event.Protocol], seq, min)
+	if class := event.HttpStatus / 100; class > 0 {
+		s.byStatusClass[class] = appendSeq(s.byStatusClass[class], seq, min)
+	}
+
+	if evicted != nil {
+		if evicted.Namespace != "" {
+			trimIndex(s.byNamespace, evicted.Namespace, min)
+		}
+		if evicted.PodName != "" {
+			trimIndex(s.byPod, evicted.PodName, min)
+		}
+		trimIndex(s.byProtocol, evicted.Protocol, min)
+		if class := evicted.HttpStatus / 100; class > 0 {
+			trimIndex(s.byStatusClass, class, min)
+		}
+	}
+}
+
+// get은 seq의 이벤트를 반환한다. 덮어쓰였으면 nil. 호출자가 락을 잡는다.
+func (s *shard) get(seq uint64) *nefiv1.TraceEvent {
+	if seq < s.minSeq() || seq >= s.seq {
+		return nil
+	}
+	return s.ring[seq%uint64(s.capacity)]
+}
+
+// candidates는 filter에서 가장 선택적인(짧은) posting list를 고른다.
+// 활성 필터가 없으면 (nil, false). 호출자가 RLock을 잡는다.
+func (s *shard) candidates(f *Filter) ([]uint64, bool) {
+	var best []uint64
+	found := false
+	consider := func(list []uint64) {
+		if !found || len(list) < len(best) {
+			best = list
+			found = true
+		}
+	}
+	if f.PodName != "" {
+		consider(s.byPod[f.PodName])
+	}
+	if f.Namespace != "" {
+		consider(s.byNamespace[f.Namespace])
+	}
+	if f.StatusClass != 0 {
+		consider(s.byStatusClass[f.StatusClass])
+	}
+	if f.Protocol != 0 {
+		consider(s.byProtocol[f.Protocol])
+	}
+	return best, found
+}
+
+// query는 filter에 맞는 최신 이벤트를 최대 limit개, 최신순으로 반환한다.
+func (s *shard) query(f *Filter, limit int) []*nefiv1.TraceEvent {
+	s.mu.RLock()
+	defer s.mu.RUnlock()
+
+	result := make([]*nefiv1.TraceEvent, 0, limit)
+
+	if list, ok := s.candidates(f); ok {
+		// 인덱스 경로: posting list를 최신(끝)부터 걷는다.
+		for i := len(list) - 1; i >= 0 && len(result) < limit; i-- {
+			ev := s.get(list[i])
+			if ev != nil && f.Match(ev) {
+				result = append(result, ev)
+			}
+		}
+		return result
+	}
+
+	// 필터 없음: ring을 최신부터 걷는다.
+	for off := uint64(1); off <= uint64(s.count) && len(result) < limit; off++ {
+		result = append(result, s.ring[(s.seq-off)%uint64(s.capacity)])
+	}
+	return result
+}
+
+// Store는 shard 배열 + copy-on-write 구독자 목록으로 구성된다.
 type Store struct {
-	mu          sync.RWMutex
-	ring        []*nefiv1.TraceEvent
-	capacity    int
-	head        int // 다음 쓰기 위치 (항상 0 ≤ head < capacity)
-	count       int // 저장된 이벤트 수 (최대 capacity)
-	closed      bool
-	subscribers map[chan *nefiv1.TraceEvent]struct{}
+	shards [numShards]*shard
+
+	subMu  sync.Mutex                                // 구독자 목록 변경 직렬화
+	subs   atomic.Pointer[[]chan *nefiv1.TraceEvent] // COW 스냅샷 (Add는 load만)
+	closed atomic.Bool
 }
 
-// New는 주어진 capacity의 인메모리 Store를 반환한다.
+// New는 주어진 총 capacity의 인메모리 Store를 반환한다.
+// capacity는 shard들에 균등 분배된다.
 func New(capacity int) *Store {
 	if capacity <= 0 {
 		capacity = 1000
 	}
-	return &Store{
-		ring:        make([]*nefiv1.TraceEvent, capacity),
-		capacity:    capacity,
-		subscribers: make(map[chan *nefiv1.TraceEvent]struct{}),
+	perShard := capacity / numShards
+	if perShard < 16 {
+		perShard = 16
+	}
+	s := &Store{}
+	for i := range s.shards {
+		s.shards[i] = newShard(perShard)
+	}
+	empty := []chan *nefiv1.TraceEvent{}
+	s.subs.Store(&empty)
+	return s
+}
+
+// shardFor는 pod 이름(없으면 PID) 해시로 shard 인덱스를 고른다 — 같은
+// pod의 이벤트는 같은 shard에 모여 pod 필터 조회의 지역성이 좋아진다.
+func shardFor(event *nefiv1.TraceEvent) int {
+	const (
+		offset32 = 2166136261
+		prime32  = 16777619
+	)
+	h := uint32(offset32)
+	if event.PodName != "" {
+		for i := 0; i < len(event.PodName); i++ {
+			h ^= uint32(event.PodName[i])
+			h *= prime32
+		}
+	} else {
+		h ^= event.Pid
+		h *= prime32
 	}
+	return int(h & (numShards - 1))
 }
 
-// Add는 이벤트를 ring buffer에 저장하고 구독자에게 전파한다.
+// Add는 이벤트를 shard에 저장하고 구독자에게 전파한다.
 func (s *Store) Add(event *nefiv1.TraceEvent) {
-	s.mu.Lock()
-	if s.closed {
-		s.mu.Unlock()
+	if s.closed.Load() {
 		return
 	}
-	s.ring[s.head] = event
-	s.head = (s.head + 1) % s.capacity
-	if s.count < s.capacity {
-		s.count++
+	sh := s.shards[shardFor(event)]
+	sh.mu.Lock()
+	sh.add(event)
+	sh.mu.Unlock()
+
+	s.fanout(event)
+}
+
+// AddBatch는 여러 이벤트를 shard별로 묶어 shard당 한 번의 락으로 저장한다.
+// events 슬라이스 자체는 보관하지 않으므로 호출자가 재사용해도 된다.
+func (s *Store) AddBatch(events []*nefiv1.TraceEvent) {
+	if len(events) == 0 || s.closed.Load() {
+		return
 	}
-	// 구독자 목록 복사 후 뮤텍스 해제 (채널 send 중 데드락 방지)
-	subs := make([]chan *nefiv1.TraceEvent, 0, len(s.subscribers))
-	for ch := range s.subscribers {
-		subs = append(subs, ch)
+	var groups [numShards][]*nefiv1.TraceEvent
+	for _, event := range events {
+		idx := shardFor(event)
+		groups[idx] = append(groups[idx], event)
 	}
-	s.mu.Unlock()
+	for i, group := range groups {
+		if len(group) == 0 {
+			continue
+		}
+		sh := s.shards[i]
+		sh.mu.Lock()
+		for _, event := range group {
+			sh.add(event)
+		}
+		sh.mu.Unlock()
+	}
+	// 스냅샷을 배치당 한 번만 load한다 — 배치 중간의 구독자 변경은
+	// 다음 배치부터 반영되면 충분하다.
+	subs := *s.subs.Load()
+	for _, event := range events {
+		for _, ch := range subs {
+			select {
+			case ch <- event:
+			default: // 구독자가 느리면 drop
+			}
+		}
+	}
+}
 
-	for _, ch := range subs {
+// fanout은 COW 구독자 스냅샷으로 비블로킹 전파한다 — 락도 복사도 없다.
+func (s *Store) fanout(event *nefiv1.TraceEvent) {
+	for _, ch := range *s.subs.Load() {
 		select {
 		case ch <- event:
 		default:
@@ -68,58 +333,69 @@ func (s *Store) Add(event *nefiv1.TraceEvent) {
 // Subscribe는 새 이벤트 구독 채널을 반환한다.
 func (s *Store) Subscribe() <-chan *nefiv1.TraceEvent {
 	ch := make(chan *nefiv1.TraceEvent, subscriberChanSize)
-	s.mu.Lock()
-	s.subscribers[ch] = struct{}{}
-	s.mu.Unlock()
+	s.subMu.Lock()
+	old := *s.subs.Load()
+	next := make([]chan *nefiv1.TraceEvent, len(old)+1)
+	copy(next, old)
+	next[len(old)] = ch
+	s.subs.Store(&next)
+	s.subMu.Unlock()
 	return ch
 }
 
 // Unsubscribe는 구독 채널을 해제하고 닫는다.
 func (s *Store) Unsubscribe(ch <-chan *nefiv1.TraceEvent) {
-	s.mu.Lock()
-	for k := range s.subscribers {
-		if k == ch {
-			delete(s.subscribers, k)
-			close(k)
-			break
+	s.subMu.Lock()
+	old := *s.subs.Load()
+	next := make([]chan *nefiv1.TraceEvent, 0, len(old))
+	for _, c := range old {
+		if c == ch {
+			close(c)
+			continue
 		}
+		next = append(next, c)
 	}
-	s.mu.Unlock()
+	s.subs.Store(&next)
+	s.subMu.Unlock()
 }
 
-// Recent는 최근 n개 이벤트를 오래된 것부터 반환한다.
-func (s *Store) Recent(n int) []*nefiv1.TraceEvent {
-	s.mu.RLock()
-	defer s.mu.RUnlock()
-
-	if n <= 0 || s.count == 0 {
+// Query는 filter에 맞는 최신 이벤트를 최대 limit개, 오래된 것부터 반환한다.
+// 활성 필터가 있으면 보조 인덱스 posting list만 걷는다.
+func (s *Store) Query(f Filter, limit int) []*nefiv1.TraceEvent {
+	if limit <= 0 {
 		return []*nefiv1.TraceEvent{}
 	}
-	if n > s.count {
-		n = s.count
+
+	merged := make([]*nefiv1.TraceEvent, 0, limit)
+	for _, sh := range s.shards {
+		merged = append(merged, sh.query(&f, limit)...)
 	}
 
-	result := make([]*nefiv1.TraceEvent, n)
-	// head는 다음 쓰기 위치 → (head - count + capacity) % capacity 가 가장 오래된 위치
-	start := ((s.head - s.count) + s.capacity) % s.capacity
-	for i := 0; i < n; i++ {
-		// n개 중 최신 n개: (count - n)개 건너뜀
-		idx := (start + (s.count - n) + i) % s.capacity
-		result[i] = s.ring[idx]
+	// shard별 결과를 시간순으로 합치고 최신 limit개만 남긴다.
+	sort.Slice(merged, func(i, j int) bool {
+		return merged[i].TimestampNs < merged[j].TimestampNs
+	})
+	if len(merged) > limit {
+		merged = merged[len(merged)-limit:]
 	}
-	return result
+	return merged
+}
+
+// Recent는 최근 n개 이벤트를 오래된 것부터 반환한다.
+func (s *Store) Recent(n int) []*nefiv1.TraceEvent {
+	return s.Query(Filter{}, n)
 }
 
 // Close는 모든 구독 채널을 닫는다.
 func (s *Store) Close() {
-	s.mu.Lock()
-	defer s.mu.Unlock()
-	if s.closed {
+	if !s.closed.CompareAndSwap(false, true) {
 		return
 	}
-	s.closed = true
-	for ch := range s.subscribers {
+	s.subMu.Lock()
+	for _, ch := range *s.subs.Load() {
 		close(ch)
 	}
-	s.subscribers = make(map[chan *nefiv1.TraceEvent]struct{})
+	empty := []chan *nefiv1.TraceEvent{}
+	s.subs.Store(&empty)
+	s.subMu.Unlock()
 }
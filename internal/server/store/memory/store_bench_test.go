@@ -0,0 +1,107 @@
+package memory
+
+import (
+	"fmt"
+	"testing"
+
+	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
+)
+
+func benchEvent(i int) *nefiv1.TraceEvent {
+	return &nefiv1.TraceEvent{
+		TimestampNs: uint64(i),
+		Pid:         uint32(i),
+		Namespace:   "default",
+		PodName:     fmt.Sprintf("api-6d4cf56db6-%03d", i%32),
+		Protocol:    1,
+		HttpStatus:  200,
+	}
+}
+
+func BenchmarkAdd(b *testing.B) {
+	s := New(10000)
+	defer s.Close()
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		s.Add(benchEvent(i))
+	}
+}
+
+// collector worker들이 서로 다른 pod의 이벤트를 동시에 쓰는 경우 —
+// shard 분산 효과를 본다.
+func BenchmarkAddParallel(b *testing.B) {
+	s := New(10000)
+	defer s.Close()
+	b.ReportAllocs()
+	b.RunParallel(func(pb *testing.PB) {
+		i := 0
+		for pb.Next() {
+			s.Add(benchEvent(i))
+			i++
+		}
+	})
+}
+
+// 운영 구성과 같은 3개 구독자(aggregator/hub/topology)가 붙은 상태의
+// ingest 경로 — fan-out이 COW 스냅샷 load만 하고 락/할당이 없는지 본다.
+func BenchmarkAddFanout(b *testing.B) {
+	s := New(10000)
+	defer s.Close()
+	for i := 0; i < 3; i++ {
+		ch := s.Subscribe()
+		go func() {
+			for range ch {
+			}
+		}()
+	}
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		s.Add(benchEvent(i))
+	}
+}
+
+func BenchmarkAddBatch(b *testing.B) {
+	s := New(10000)
+	defer s.Close()
+	batch := make([]*nefiv1.TraceEvent, 128)
+	for i := range batch {
+		batch[i] = benchEvent(i)
+	}
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		s.AddBatch(batch)
+	}
+}
+
+func BenchmarkRecent(b *testing.B) {
+	s := New(10000)
+	defer s.Close()
+	for i := 0; i < 10000; i++ {
+		s.Add(benchEvent(i))
+	}
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if evs := s.Recent(100); len(evs) != 100 {
+			b.Fatalf("got %d events", len(evs))
+		}
+	}
+}
+
+// 보조 인덱스 경로 — pod 하나로 좁히는 드릴다운 조회.
+func BenchmarkQueryByPod(b *testing.B) {
+	s := New(10000)
+	defer s.Close()
+	for i := 0; i < 10000; i++ {
+		s.Add(benchEvent(i))
+	}
+	f := Filter{PodName: "api-6d4cf56db6-007"}
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if evs := s.Query(f, 100); len(evs) == 0 {
+			b.Fatal("no events matched")
+		}
+	}
+}
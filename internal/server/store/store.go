@@ -3,19 +3,46 @@ package store
 
 import (
 	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
+	"github.com/gihongjo/nefi/internal/server/store/disk"
 	"github.com/gihongjo/nefi/internal/server/store/memory"
 )
 
+// Filter는 Query의 선택 조건이다. zero value 필드는 "무관"을 뜻한다.
+// (구현 패키지가 정의하고 여기서 재노출한다 — import 방향 때문.)
+type Filter = memory.Filter
+
 // Store는 이벤트 저장소 인터페이스다.
 type Store interface {
 	Add(event *nefiv1.TraceEvent)
+	// AddBatch는 여러 이벤트를 shard당 한 번의 락 획득으로 저장한다.
+	// collector의 batch-commit 경로가 사용한다. 전달된 슬라이스는
+	// 리턴 후 호출자가 재사용해도 된다.
+	AddBatch(events []*nefiv1.TraceEvent)
 	Subscribe() <-chan *nefiv1.TraceEvent
 	Unsubscribe(ch <-chan *nefiv1.TraceEvent)
 	Recent(n int) []*nefiv1.TraceEvent
+	// Query는 filter에 맞는 최신 이벤트를 최대 limit개, 오래된 것부터
+	// 반환한다. 보조 인덱스를 타므로 전체 스캔 없이 드릴다운이 가능하다.
+	Query(f Filter, limit int) []*nefiv1.TraceEvent
 	Close()
 }
 
+// RangeQuerier는 영속 Store가 추가로 제공하는 히스토리 조회 능력이다.
+// 호출 측은 type assertion으로 지원 여부를 확인한다 (http.Flusher 방식).
+type RangeQuerier interface {
+	// QueryRange는 [fromNs, toNs] 범위의 이벤트를 filter로 걸러 최대
+	// limit개, 오래된 것부터 반환한다. toNs 0은 상한 없음이다.
+	QueryRange(fromNs, toNs uint64, f Filter, limit int) ([]*nefiv1.TraceEvent, error)
+}
+
 // New는 인메모리 Store를 반환한다.
 func New(capacity int) Store {
 	return memory.New(capacity)
 }
+
+// NewPersistent는 dir 아래 세그먼트 파일로 영속화되는 Store를 반환한다.
+// 인메모리 ring은 write-through hot tier로 유지되고, 재시작 시 최근
+// 이벤트가 복원된다. RangeQuerier를 구현한다.
+func NewPersistent(dir string, capacity int) (Store, error) {
+	return disk.New(dir, capacity)
+}
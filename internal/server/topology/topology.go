@@ -0,0 +1,261 @@
+// Package topology는 workload 간 호출 그래프를 증분 유지하는 인덱스다.
+//
+// 역할:
+//   aggregator처럼 store를 한 번 구독해 응답 이벤트를 1초 단위 bucket의
+//   엣지 카운터(호출 수/성공/에러/latency 합)로 접어 둔다. API 핸들러는
+//   Snapshot(windowSec)으로 미리 계산된 그래프를 O(엣지 수)에 받는다 —
+//   요청마다 최근 이벤트 수만 개를 다시 스캔하던 비용이 사라지고, 응답
+//   시간이 raw 이벤트 양과 무관해진다.
+//
+// 엣지 방향 (요청 방향, A→B = A가 B를 호출):
+//   Direction 0(SEND, 응답 송신): 로컬이 서버 → 리모트(클라이언트)→로컬
+//   Direction 1(RECV, 응답 수신): 로컬이 클라이언트 → 로컬→리모트(서버)
+package topology
+
+import (
+	"fmt"
+	"sync"
+	"time"
+
+	nefiv1 "github.com/gihongjo/nefi/gen/go/nefi/v1"
+	"github.com/gihongjo/nefi/internal/server/aggregator"
+	"github.com/gihongjo/nefi/internal/server/store"
+)
+
+const (
+	maxWindowSec     = 300 // 최대 윈도우: 5분 (aggregator와 동일)
+	DefaultWindowSec = 60
+)
+
+// Node는 그래프의 workload 노드다.
+// json 태그는 replica 간 merge용 /api/v1/topology/raw 직렬화에 쓰인다.
+type Node struct {
+	ID        string `json:"id"`
+	Namespace string `json:"namespace"`
+	Workload  string `json:"workload"`
+}
+
+// Edge는 윈도우 내 집계된 호출 엣지다. 모든 카운터가 덧셈으로 merge되는
+// 원시 합이므로 replica 간 합산 뒤에 rate/평균을 계산할 수 있다.
+type Edge struct {
+	Source       string `json:"source"`
+	Target       string `json:"target"`
+	Total        int64  `json:"total"`
+	Success      int64  `json:"success"`
+	Error        int64  `json:"error"`
+	LatencySumNs int64  `json:"latency_sum_ns"`
+	LatencyCount int64  `json:"latency_count"`
+}
+
+type edgeKey struct {
+	src string
+	dst string
+}
+
+type edgeCounts struct {
+	total        int64
+	success      int64
+	error        int64
+	latencySumNs int64
+	latencyCount int64
+}
+
+func (c *edgeCounts) merge(o *edgeCounts) {
+	c.total += o.total
+	c.success += o.success
+	c.error += o.error
+	c.latencySumNs += o.latencySumNs
+	c.latencyCount += o.latencyCount
+}
+
+// bucket은 1초 구간의 엣지 카운터와 그 구간에 관측된 노드 정보다.
+// 노드도 bucket에 묶어 두므로 윈도우에서 밀려난 workload는 그래프에서도
+// 사라진다.
+type bucket struct {
+	sec   int64
+	nodes map[string]Node
+	edges map[edgeKey]edgeCounts
+}
+
+// Topology는 슬라이딩 윈도우 호출 그래프 인덱스다.
+// 엣지 cardinality는 endpoint보다 훨씬 낮으므로 (workload 쌍 단위)
+// aggregator와 달리 shard 없이 mutex 하나로 충분하다.
+type Topology struct {
+	mu      sync.Mutex
+	buckets []bucket
+
+	store    store.Store
+	storeSub <-chan *nefiv1.TraceEvent
+	done     chan struct{}
+}
+
+// New는 store를 구독하고 백그라운드 인덱싱을 시작하는 Topology를 반환한다.
+func New(s store.Store) *Topology {
+	t := &Topology{
+		store:    s,
+		storeSub: s.Subscribe(),
+		done:     make(chan struct{}),
+	}
+	go t.consume()
+	go t.pruneLoop()
+	return t
+}
+
+// Close는 인덱싱을 중단하고 store 구독을 해제한다.
+func (t *Topology) Close() {
+	close(t.done)
+	t.store.Unsubscribe(t.storeSub)
+}
+
+// Snapshot은 주어진 windowSec(1~300) 범위의 그래프를 반환한다.
+func (t *Topology) Snapshot(windowSec int) ([]Node, []Edge) {
+	if windowSec < 1 {
+		windowSec = 1
+	}
+	if windowSec > maxWindowSec {
+		windowSec = maxWindowSec
+	}
+	cutoff := time.Now().Unix() - int64(windowSec)
+
+	mergedNodes := make(map[string]Node)
+	mergedEdges := make(map[edgeKey]edgeCounts)
+	t.mu.Lock()
+	for i := range t.buckets {
+		b := &t.buckets[i]
+		if b.sec <= cutoff {
+			continue
+		}
+		for id, n := range b.nodes {
+			mergedNodes[id] = n
+		}
+		for k, c := range b.edges {
+			m := mergedEdges[k]
+			m.merge(&c)
+			mergedEdges[k] = m
+		}
+	}
+	t.mu.Unlock()
+
+	nodes := make([]Node, 0, len(mergedNodes))
+	for _, n := range mergedNodes {
+		nodes = append(nodes, n)
+	}
+	edges := make([]Edge, 0, len(mergedEdges))
+	for k, c := range mergedEdges {
+		edges = append(edges, Edge{
+			Source:       k.src,
+			Target:       k.dst,
+			Total:        c.total,
+			Success:      c.success,
+			Error:        c.error,
+			LatencySumNs: c.latencySumNs,
+			LatencyCount: c.latencyCount,
+		})
+	}
+	return nodes, edges
+}
+
+// consume은 store 구독 채널에서 이벤트를 받아 bucket에 기록한다.
+func (t *Topology) consume() {
+	for {
+		select {
+		case <-t.done:
+			return
+		case ev, ok := <-t.storeSub:
+			if !ok {
+				return
+			}
+			t.record(ev)
+		}
+	}
+}
+
+// record는 HTTP 응답 이벤트 하나를 현재 초 bucket의 엣지에 반영한다.
+// 노드/엣지 식별 규칙은 기존 /api/v1/topology 핸들러의 스캔 로직과 같다:
+// 로컬은 K8s pod만(호스트 프로세스 제외), 리모트는 pod 이름 > pod IP 순.
+func (t *Topology) record(ev *nefiv1.TraceEvent) {
+	if ev.HttpStatus == 0 || ev.PodName == "" {
+		return
+	}
+
+	localWorkload := aggregator.WorkloadName(ev.PodName)
+	localID := localWorkload
+	if ev.Namespace != "" {
+		localID = ev.Namespace + "/" + localWorkload
+	}
+
+	remoteWorkload := aggregator.WorkloadName(ev.RemotePod)
+	remoteID := remoteWorkload
+	if ev.RemoteNs != "" {
+		remoteID = ev.RemoteNs + "/" + remoteWorkload
+	}
+	if remoteID == "" {
+		if ev.RemoteIp == 0 {
+			return
+		}
+		remoteID = fmt.Sprintf("%d.%d.%d.%d",
+			(ev.RemoteIp>>24)&0xff, (ev.RemoteIp>>16)&0xff,
+			(ev.RemoteIp>>8)&0xff, ev.RemoteIp&0xff)
+		remoteWorkload = remoteID
+	}
+
+	var key edgeKey
+	if ev.Direction == 0 {
+		key = edgeKey{src: remoteID, dst: localID}
+	} else {
+		key = edgeKey{src: localID, dst: remoteID}
+	}
+
+	sec := time.Now().Unix()
+	t.mu.Lock()
+	if len(t.buckets) == 0 || t.buckets[len(t.buckets)-1].sec != sec {
+		t.buckets = append(t.buckets, bucket{
+			sec:   sec,
+			nodes: make(map[string]Node),
+			edges: make(map[edgeKey]edgeCounts),
+		})
+	}
+	b := &t.buckets[len(t.buckets)-1]
+	if _, ok := b.nodes[localID]; !ok {
+		b.nodes[localID] = Node{ID: localID, Namespace: ev.Namespace, Workload: localWorkload}
+	}
+	if _, ok := b.nodes[remoteID]; !ok {
+		b.nodes[remoteID] = Node{ID: remoteID, Namespace: ev.RemoteNs, Workload: remoteWorkload}
+	}
+	c := b.edges[key]
+	c.total++
+	if ev.HttpStatus >= 200 && ev.HttpStatus < 400 {
+		c.success++
+	} else if ev.HttpStatus >= 400 {
+		c.error++
+	}
+	if ev.LatencyNs > 0 {
+		c.latencySumNs += int64(ev.LatencyNs)
+		c.latencyCount++
+	}
+	b.edges[key] = c
+	t.mu.Unlock()
+}
+
+// pruneLoop는 매 1초마다 maxWindowSec보다 오래된 bucket을 버린다.
+func (t *Topology) pruneLoop() {
+	ticker := time.NewTicker(time.Second)
+	defer ticker.Stop()
+	for {
+		select {
+		case <-t.done:
+			return
+		case <-ticker.C:
+			cutoff := time.Now().Unix() - maxWindowSec
+			t.mu.Lock()
+			i := 0
+			for i < len(t.buckets) && t.buckets[i].sec <= cutoff {
+				i++
+			}
+			if i > 0 {
+				t.buckets = append([]bucket(nil), t.buckets[i:]...)
+			}
+			t.mu.Unlock()
+		}
+	}
+}
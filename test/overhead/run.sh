@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+# nefi syscall 오버헤드 측정 하네스
+#
+# baseline(agent 없음) → agent 켠 상태 순으로 workload를 돌려
+# write/read 왕복 레이턴시 차이를 출력한다. nefi_trace.c의 tracepoint는
+# 시스템 전역이므로 root로, 가능하면 한가한 노드에서 실행할 것.
+#
+# 사용:
+#   sudo test/overhead/run.sh [-n iterations]
+#
+# 요구사항: root, go 툴체인, 커널 BTF (agent가 로드될 수 있는 환경)
+set -euo pipefail
+
+REPO_ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+ITERATIONS="${2:-100000}"
+if [ "${1:-}" = "-n" ]; then ITERATIONS="$2"; fi
+
+WORKLOAD="$REPO_ROOT/_overhead/workload"
+AGENT="$REPO_ROOT/_overhead/nefi-agent"
+
+echo "[*] building workload and agent..."
+mkdir -p "$REPO_ROOT/_overhead"
+(cd "$REPO_ROOT" && go build -o "$WORKLOAD" ./test/overhead/workload)
+(cd "$REPO_ROOT" && go build -o "$AGENT" ./cmd/nefi-agent)
+
+echo
+echo "=== baseline (no agent) ==="
+BASELINE=$("$WORKLOAD" -n "$ITERATIONS")
+echo "$BASELINE"
+
+echo
+echo "=== with nefi-agent ==="
+# --server-addr 없이 stdout 모드로 — 캡처→ringbuf→디코드 경로는 전부 활성화된다.
+"$AGENT" --metrics-addr "" >/dev/null 2>&1 &
+AGENT_PID=$!
+trap 'kill "$AGENT_PID" 2>/dev/null || true' EXIT
+sleep 3 # probe attach 대기
+
+if ! kill -0 "$AGENT_PID" 2>/dev/null; then
+    echo "agent failed to start (root? BTF?)" >&2
+    exit 1
+fi
+
+TRACED=$("$WORKLOAD" -n "$ITERATIONS")
+echo "$TRACED"
+
+kill "$AGENT_PID" 2>/dev/null || true
+trap - EXIT
+
+echo
+echo "=== overhead ==="
+base_p50=$(echo "$BASELINE" | grep -o 'p50_ns=[0-9]*' | cut -d= -f2)
+trac_p50=$(echo "$TRACED"   | grep -o 'p50_ns=[0-9]*' | cut -d= -f2)
+base_p99=$(echo "$BASELINE" | grep -o 'p99_ns=[0-9]*' | cut -d= -f2)
+trac_p99=$(echo "$TRACED"   | grep -o 'p99_ns=[0-9]*' | cut -d= -f2)
+echo "p50: ${base_p50}ns -> ${trac_p50}ns (+$((trac_p50 - base_p50))ns/round-trip)"
+echo "p99: ${base_p99}ns -> ${trac_p99}ns (+$((trac_p99 - base_p99))ns/round-trip)"
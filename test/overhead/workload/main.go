@@ -0,0 +1,99 @@
+// workload — syscall 레이턴시 측정용 인스트루먼트 대상
+//
+// 역할:
+//
+//	loopback TCP 연결 위에서 write(2)→read(2) 왕복을 반복하며 왕복당
+//	소요 시간을 측정하고 p50/p95/p99/평균(ns)을 출력한다. 이 경로는
+//	bpf/nefi_trace.c가 후킹하는 syscall tracepoint를 그대로 지나가므로,
+//	agent를 켠 상태/끈 상태에서 각각 실행해 차이를 보면 nefi가 워크로드에
+//	더하는 syscall 오버헤드가 나온다. 오케스트레이션은 ../run.sh 참고.
+//
+// 페이로드를 "GET / HTTP/1.1..."로 보내는 이유: protocol detection을
+// 통과해야 캡처→ringbuf 경로(최대 비용 경로)까지 측정되기 때문이다.
+package main
+
+import (
+	"flag"
+	"fmt"
+	"log"
+	"net"
+	"os"
+	"sort"
+	"time"
+)
+
+func main() {
+	iterations := flag.Int("n", 100000, "round trips to measure")
+	warmup := flag.Int("warmup", 1000, "round trips before measuring")
+	flag.Parse()
+
+	// loopback echo 서버
+	ln, err := net.Listen("tcp", "127.0.0.1:0")
+	if err != nil {
+		log.Fatalf("listen: %v", err)
+	}
+	defer ln.Close()
+	go func() {
+		conn, err := ln.Accept()
+		if err != nil {
+			return
+		}
+		defer conn.Close()
+		buf := make([]byte, 4096)
+		resp := []byte("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok")
+		for {
+			if _, err := conn.Read(buf); err != nil {
+				return
+			}
+			if _, err := conn.Write(resp); err != nil {
+				return
+			}
+		}
+	}()
+
+	conn, err := net.Dial("tcp", ln.Addr().String())
+	if err != nil {
+		log.Fatalf("dial: %v", err)
+	}
+	defer conn.Close()
+
+	req := []byte("GET /bench HTTP/1.1\r\nHost: localhost\r\n\r\n")
+	buf := make([]byte, 4096)
+	roundTrip := func() time.Duration {
+		start := time.Now()
+		if _, err := conn.Write(req); err != nil {
+			log.Fatalf("write: %v", err)
+		}
+		if _, err := conn.Read(buf); err != nil {
+			log.Fatalf("read: %v", err)
+		}
+		return time.Since(start)
+	}
+
+	for i := 0; i < *warmup; i++ {
+		roundTrip()
+	}
+
+	samples := make([]time.Duration, *iterations)
+	for i := range samples {
+		samples[i] = roundTrip()
+	}
+
+	sort.Slice(samples, func(i, j int) bool { return samples[i] < samples[j] })
+	var sum time.Duration
+	for _, s := range samples {
+		sum += s
+	}
+	pct := func(q float64) time.Duration {
+		idx := int(q * float64(len(samples)))
+		if idx >= len(samples) {
+			idx = len(samples) - 1
+		}
+		return samples[idx]
+	}
+
+	fmt.Printf("pid=%d n=%d\n", os.Getpid(), *iterations)
+	fmt.Printf("avg_ns=%d p50_ns=%d p95_ns=%d p99_ns=%d\n",
+		sum.Nanoseconds()/int64(len(samples)),
+		pct(0.50).Nanoseconds(), pct(0.95).Nanoseconds(), pct(0.99).Nanoseconds())
+}